@@ -0,0 +1,213 @@
+/*
+  Audio tap: lock-free block feed from onSound to analysis threads
+
+  onSound writes each block into a preallocated ring of planar slots
+  (channels x maxFrames), one memcpy per channel from the output buffers.
+  Any number of consumer threads (up to MAX_CONSUMERS) subscribe before
+  audio starts and each reads the ring at its own pace with its own cursor.
+
+  The writer never waits and drops per consumer: a consumer whose backlog
+  reaches 3/4 of the ring is moved on to the newest half and loses the
+  blocks in between alone (counted as its overflows). The block a consumer
+  holds between read() and release() is never overwritten, which the
+  remaining quarter ring leaves room for; only a consumer stuck on one
+  block that long makes the writer drop a block for everyone (the tap's
+  dropped count). Every slot carries the index of the block it holds, so
+  consumers see gaps and can restart filter state instead of treating the
+  discontinuity as signal.
+
+  Inactive consumers hold nothing back: a consumer switched on again
+  starts at the newest block.
+*/
+
+#ifndef AUDIO_TAP_HPP
+#define AUDIO_TAP_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "al/io/al_AudioIOData.hpp"
+
+// One block as seen by a consumer (valid until release())
+struct audio_tap_block {
+  const float* data = nullptr;  // Planar: channel ch starts at data + ch * stride
+  int channels = 0;
+  int frames = 0;
+  int stride = 0;
+  uint64_t index = 0;           // Block number since prepare(), including dropped ones
+  bool gap = false;             // Blocks were dropped since this consumer's last one
+
+  const float* channel(int ch) const { return data + (size_t)ch * stride; }
+};
+
+struct audio_tap {
+  static constexpr int MAX_CONSUMERS = 8;
+
+  // Allocate the ring. Must be called before audio starts and before subscribe().
+  void prepare(int numChannels, int maxBlockFrames, int numSlots = 32) {
+    channels = numChannels;
+    maxFrames = maxBlockFrames;
+    slots = (uint64_t)std::max(4, numSlots);
+    ringData.assign((size_t)slots * channels * maxFrames, 0.0f);
+    slotFrames.assign(slots, 0);
+    slotIndex.assign(slots, 0);
+    writeIndex.store(0);
+    blocksOffered = 0;
+    dropped.store(0);
+    consumerCount = 0;
+    for (int c = 0; c < MAX_CONSUMERS; c++) {
+      cursor[c].store(0);
+      holding[c].store(NOT_HOLDING);
+      active[c].store(false);
+      overflowCount[c].store(0);
+      nextBlock[c] = 0;
+    }
+  }
+
+  // Register a consumer (before audio starts). Returns its id, or -1 if full.
+  // Consumers start inactive; call setActive() from the consumer thread.
+  int subscribe(const std::string& name) {
+    if (consumerCount == MAX_CONSUMERS) return -1;
+    names[consumerCount] = name;
+    return consumerCount++;
+  }
+
+  int consumers() const { return consumerCount; }
+  const std::string& consumerName(int consumer) const { return names[consumer]; }
+  int numChannels() const { return channels; }
+  int maxBlockFrames() const { return maxFrames; }
+
+  // ---- Audio thread ----
+
+  // Copy the output buffers (post-routing / post-DSP)
+  void write(const al::AudioIOData& io, int frames) {
+    float* dst = beginWrite(frames);
+    if (!dst) return;
+    int copied = std::min(channels, io.channelsOut());
+    for (int ch = 0; ch < copied; ch++) {
+      std::memcpy(dst + (size_t)ch * maxFrames, io.outBuffer(ch), pendingFrames * sizeof(float));
+    }
+    for (int ch = copied; ch < channels; ch++) {
+      std::memset(dst + (size_t)ch * maxFrames, 0, pendingFrames * sizeof(float));
+    }
+    endWrite();
+  }
+
+  // ---- Consumer threads (each consumer from one thread) ----
+
+  void setActive(int consumer, bool on) {
+    if (on) {
+      cursor[consumer].store(writeIndex.load(std::memory_order_acquire), std::memory_order_relaxed);
+      nextBlock[consumer] = 0;  // Unknown: first block is never reported as a gap
+      active[consumer].store(true, std::memory_order_release);
+    } else {
+      active[consumer].store(false, std::memory_order_release);
+    }
+  }
+
+  // Oldest unread block, or false if the consumer is caught up
+  bool read(int consumer, audio_tap_block& block) {
+    uint64_t r = cursor[consumer].load();
+    while (true) {
+      if (r == writeIndex.load(std::memory_order_acquire)) return false;
+      // Claim the slot, then make sure the writer didn't move us past it
+      // meanwhile (it checks holding after moving the cursor)
+      holding[consumer].store(r);
+      uint64_t now = cursor[consumer].load();
+      if (now == r) break;
+      holding[consumer].store(NOT_HOLDING);
+      r = now;
+    }
+    size_t slot = r % slots;
+    block.data = &ringData[(size_t)slot * channels * maxFrames];
+    block.channels = channels;
+    block.frames = slotFrames[slot];
+    block.stride = maxFrames;
+    block.index = slotIndex[slot];
+    block.gap = nextBlock[consumer] != 0 && block.index != nextBlock[consumer];
+    nextBlock[consumer] = block.index + 1;
+    return true;
+  }
+
+  // Hand the block from read() back to the writer
+  void release(int consumer) {
+    uint64_t r = holding[consumer].load(std::memory_order_relaxed);
+    // Fails if the writer already moved the cursor past an overflow
+    cursor[consumer].compare_exchange_strong(r, r + 1);
+    holding[consumer].store(NOT_HOLDING, std::memory_order_release);
+  }
+
+  bool pending(int consumer) const {
+    return cursor[consumer].load(std::memory_order_relaxed) != writeIndex.load(std::memory_order_acquire);
+  }
+
+  // ---- Stats (any thread) ----
+
+  uint64_t overflows(int consumer) const { return overflowCount[consumer].load(std::memory_order_relaxed); }
+  uint64_t droppedBlocks() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+  int channels = 0;
+  int maxFrames = 0;
+  uint64_t slots = 32;
+
+  std::vector<float> ringData;      // slots x channels x maxFrames
+  std::vector<int> slotFrames;
+  std::vector<uint64_t> slotIndex;  // Block number held by each slot
+  std::atomic<uint64_t> writeIndex{0};
+  uint64_t blocksOffered = 0;       // Audio thread only
+  int pendingFrames = 0;            // Audio thread only
+  std::atomic<uint64_t> dropped{0};
+
+  static constexpr uint64_t NOT_HOLDING = ~0ull;
+
+  int consumerCount = 0;
+  std::string names[MAX_CONSUMERS];
+  std::atomic<uint64_t> cursor[MAX_CONSUMERS];   // Next block to read
+  std::atomic<uint64_t> holding[MAX_CONSUMERS];  // Block between read() and release()
+  std::atomic<bool> active[MAX_CONSUMERS];
+  std::atomic<uint64_t> overflowCount[MAX_CONSUMERS];
+  uint64_t nextBlock[MAX_CONSUMERS];  // Consumer-thread state: expected block number
+
+  // Slot to fill, or nullptr if nobody listens or a consumer still holds it.
+  // Consumers 3/4 of a ring behind skip ahead to the newest half.
+  float* beginWrite(int frames) {
+    uint64_t index = blocksOffered++;
+    uint64_t w = writeIndex.load(std::memory_order_relaxed);
+    bool listening = false, held = false;
+    for (int c = 0; c < consumerCount; c++) {
+      if (!active[c].load(std::memory_order_acquire)) continue;
+      listening = true;
+      // Move the cursor first, then look at holding: read() claims in the
+      // opposite order, so one of the two sees the other
+      uint64_t r = cursor[c].load();
+      uint64_t skipTo = w - slots / 2 + 1;
+      bool skipped = w - r >= slots - slots / 4 && cursor[c].compare_exchange_strong(r, skipTo);
+      uint64_t h = holding[c].load();
+      if (skipped) {
+        // A block being read when the cursor moves still gets delivered
+        overflowCount[c].fetch_add(skipTo - r - (h == r ? 1 : 0), std::memory_order_relaxed);
+      }
+      if (h != NOT_HOLDING && h % slots == w % slots) held = true;
+    }
+    if (!listening) return nullptr;
+    if (held) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    size_t slot = w % slots;
+    pendingFrames = std::min(frames, maxFrames);
+    slotFrames[slot] = pendingFrames;
+    slotIndex[slot] = index;
+    return &ringData[(size_t)slot * channels * maxFrames];
+  }
+
+  void endWrite() {
+    writeIndex.fetch_add(1, std::memory_order_release);
+  }
+};
+
+#endif // AUDIO_TAP_HPP
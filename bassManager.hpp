@@ -0,0 +1,192 @@
+/*
+  Bass Management
+
+  Redirects low frequencies from the 54 ring speakers to the sub:
+  - Linkwitz-Riley 4th order (two cascaded Butterworth biquads) high-pass
+    on every main output, run as one channel-parallel biquad bank
+  - Mains are summed, low-passed with the matching LR4 and added to the
+    sub output on top of its own (LFE) file channel
+
+  LR4 high-pass + low-pass sum to an all-pass, so the crossover region
+  stays flat when the sub and ring speakers play together.
+
+  Summing law (sumLaw) is a trade-off between the two kinds of bass:
+  - EQUAL_POWER (default): 1/sqrt(mains) (-17.3 dB for 54), level-correct
+    for uncorrelated bass spread over the dome, and bass common to every
+    main peaks at +17.3 dB instead of +35 dB; a single speaker's bass
+    arrives 17 dB low.
+  - UNITY: every main's bass reaches the sub at its own level, so a source
+    on a single speaker keeps its low end. Bass common to many mains adds
+    up in phase (+6 dB per doubling, +35 dB if all 54 carry the same
+    signal): reserve headroomDb for such content and raise the sub
+    amplifier by the same amount, or the limiter has to catch it.
+  subTrimDb calibrates the redirected bass against the mains in the room;
+  it and -headroomDb both apply on top of the law.
+
+  Settings changes never click: the bass-sum gain (law, trim, headroom)
+  ramps linearly over the block, and a new crossover is interpolated from
+  the current coefficients over one block, as in parametricEQ.hpp.
+
+  Operates on the frame-major output block (see biquadBank.hpp).
+*/
+
+#ifndef BASS_MANAGER_HPP
+#define BASS_MANAGER_HPP
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include "biquadBank.hpp"
+#include "channelMapping.hpp"
+
+struct bass_manager {
+  enum SumLaw { UNITY, EQUAL_POWER };
+
+  std::atomic<bool> enabled{false};  // Written by the GUI, read by the audio thread
+  std::atomic<float> crossoverHz{80.0f};  // Written by the GUI, picked up by the audio thread
+  std::atomic<int> sumLaw{EQUAL_POWER};
+  std::atomic<float> subTrimDb{0.0f};     // Calibration trim on the redirected bass
+  std::atomic<float> headroomDb{0.0f};    // Taken off the bass sum (made up at the sub amplifier)
+
+  // Preallocate for a frame-major block of `lanes` outputs and up to maxFrames
+  void prepare(int lanes, int maxFrames, double sampleRate) {
+    rate = sampleRate;
+    mainHighpass.init(lanes, 2);
+    subLowpass.init(1, 2);
+    highpassTarget.init(lanes * 2);
+    highpassFrom.init(lanes * 2);
+    lowpassTarget.init(2);
+    lowpassFrom.init(2);
+    rampLength = maxFrames;
+    bassSum.assign(maxFrames, 0.0f);
+
+    // Main outputs: every mapped output except the sub
+    mainMask.assign(lanes, 0.0f);
+    numMains = 0;
+    for (const auto& mapping : ChannelMapping::channelMap) {
+      int out = mapping.second;
+      if (out != ChannelMapping::SUB_OUTPUT_CHANNEL && out < lanes && mainMask[out] == 0.0f) {
+        mainMask[out] = 1.0f;
+        numMains++;
+      }
+    }
+    designedHz = -1.0f;
+    updateCoefficients();
+    sumGain = targetSumGain();
+  }
+
+  // Skip the ramps: the current settings apply from the next sample
+  void jumpToTargets() {
+    updateCoefficients();
+    if (ramping) {
+      mainHighpass.coeffs.copy(highpassTarget);
+      subLowpass.coeffs.copy(lowpassTarget);
+      ramping = false;
+    }
+    sumGain = targetSumGain();
+  }
+
+  // Filter a frame-major block (frames x lanes) in place
+  void process(float* block, int frames) {
+    if (!enabled.load(std::memory_order_relaxed) || frames > (int)bassSum.size() || mainHighpass.lanes == 0) return;
+    updateCoefficients();
+
+    int lanes = mainHighpass.lanes;
+    float target = targetSumGain();
+    float gainStep = (target - sumGain) / frames;
+
+    // Sum the unfiltered mains per frame (masked dot product across lanes)
+    const float* __restrict mask = mainMask.data();
+    for (int n = 0; n < frames; n++) {
+      const float* __restrict x = block + (size_t)n * lanes;
+      float sum = 0.0f;
+      for (int c = 0; c < lanes; c++) sum += x[c] * mask[c];
+      bassSum[n] = sum * (sumGain + gainStep * (n + 1));
+    }
+    sumGain = target;
+
+    if (!ramping) {
+      mainHighpass.process(block, frames);
+      subLowpass.process(bassSum.data(), frames);
+    } else {
+      // Step the crossover interpolation every RAMP_STEP frames over one block
+      for (int offset = 0; offset < frames; offset += RAMP_STEP) {
+        int count = frames - offset < RAMP_STEP ? frames - offset : RAMP_STEP;
+        if (ramping) {
+          rampPosition += count;
+          float t = rampPosition >= rampLength ? 1.0f : (float)rampPosition / (float)rampLength;
+          mainHighpass.coeffs.interpolate(highpassFrom, highpassTarget, t);
+          subLowpass.coeffs.interpolate(lowpassFrom, lowpassTarget, t);
+          ramping = t < 1.0f;
+        }
+        mainHighpass.process(block + (size_t)offset * lanes, count);
+        subLowpass.process(bassSum.data() + offset, count);
+      }
+    }
+
+    int sub = ChannelMapping::SUB_OUTPUT_CHANNEL;
+    if (sub < lanes) {
+      for (int n = 0; n < frames; n++) block[(size_t)n * lanes + sub] += bassSum[n];
+    }
+  }
+
+private:
+  static constexpr int RAMP_STEP = 16;
+
+  double rate = 48000.0;
+  biquad_bank mainHighpass;      // lanes x 2 stages (identity on non-main lanes)
+  biquad_bank subLowpass;        // 1 lane x 2 stages
+  biquad_coeff_set highpassTarget, highpassFrom;  // Crossover ramp, same layout as the banks
+  biquad_coeff_set lowpassTarget, lowpassFrom;
+  int rampLength = 512;
+  int rampPosition = 0;
+  bool ramping = false;
+  float sumGain = 1.0f;          // Bass-sum gain reached at the end of the last block
+  std::vector<float> bassSum;    // Summed mains for the current block
+  std::vector<float> mainMask;   // 1 for main outputs, 0 otherwise
+  int numMains = 0;
+  float designedHz = -1.0f;
+
+  float targetSumGain() const {
+    float lawGain = sumLaw.load(std::memory_order_relaxed) == EQUAL_POWER && numMains > 0
+                        ? 1.0f / std::sqrt((float)numMains)
+                        : 1.0f;
+    float trimDb = subTrimDb.load(std::memory_order_relaxed) - headroomDb.load(std::memory_order_relaxed);
+    return lawGain * std::pow(10.0f, trimDb / 20.0f);
+  }
+
+  // Redesign when the crossover changed and ramp to it from the current
+  // coefficients; the first design applies at once (no allocation,
+  // audio-thread safe)
+  void updateCoefficients() {
+    float hz = crossoverHz.load(std::memory_order_relaxed);
+    if (hz == designedHz) return;
+    bool first = designedHz < 0.0f;
+    designedHz = hz;
+
+    // LR4 = two identical Butterworth (Q = 1/sqrt(2)) sections
+    int lanes = mainHighpass.lanes;
+    biquad_coeffs hp = biquad_coeffs::highpass(hz, M_SQRT1_2, rate);
+    biquad_coeffs lp = biquad_coeffs::lowpass(hz, M_SQRT1_2, rate);
+    for (int c = 0; c < lanes; c++) {
+      if (mainMask[c] == 0.0f) continue;
+      highpassTarget.set(c, hp);
+      highpassTarget.set(lanes + c, hp);
+    }
+    lowpassTarget.set(0, lp);
+    lowpassTarget.set(1, lp);
+
+    if (first) {
+      mainHighpass.coeffs.copy(highpassTarget);
+      subLowpass.coeffs.copy(lowpassTarget);
+      ramping = false;
+      return;
+    }
+    highpassFrom.copy(mainHighpass.coeffs);
+    lowpassFrom.copy(subLowpass.coeffs);
+    rampPosition = 0;
+    ramping = true;
+  }
+};
+
+#endif // BASS_MANAGER_HPP
@@ -0,0 +1,144 @@
+/*
+  Metering overhead benchmark
+
+  Times the render-pass routing copy (interleaved file -> 60 planar
+  outputs, gain ramp) with and without the fused peak / RMS measurement,
+  and a separate measuring pass for comparison, at 60 channels x 512
+  frames. The fused overhead is reported relative to the routing copy it
+  rides on (the cost it adds to that pass) and as a share of the 512-frame
+  callback period at 48 kHz. Exit status 1 if fusing stops paying off
+  (the fused overhead costs more than the separate pass) or it exceeds a
+  limit: --max-overhead (percent of routing, default 75) or --max-period
+  (percent of the callback period, default 3).
+
+  Build: cmake --build build --target bench_metering
+  Run:   ./build/bench_metering [--blocks N] [--max-overhead PCT] [--max-period PCT]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include "meterKernel.hpp"
+#include "outputGains.hpp"
+
+static const int OUTPUTS = 60;
+static const int FILE_CHANNELS = 60;
+static const int FRAMES = 512;
+static const double SAMPLE_RATE = 48000.0;
+
+// Routing copy with the same gain ramp but no measurement (baseline),
+// vectorized the same way as copyRampMeasure so only the metering differs
+static void routeOnly(const float* __restrict src, int stride, float* __restrict dst, int frames, float g0,
+                      float g1, const float* __restrict shape) {
+  float delta = g1 - g0;
+#pragma omp simd
+  for (int n = 0; n < frames; n++) dst[n] = src[(size_t)n * stride] * (g0 + delta * shape[n]);
+}
+
+template <class F>
+static double nsPerBlock(int blocks, F&& block) {
+  for (int i = 0; i < blocks / 10 + 1; i++) block();  // Warm up caches
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < blocks; i++) block();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / blocks;
+}
+
+int main(int argc, char* argv[]) {
+  int blocks = 20000;
+  double maxOverheadPct = 75.0;  // Of the routing copy
+  double maxPeriodPct = 3.0;     // Of the callback period
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--blocks" && hasValue) blocks = std::max(10, std::atoi(argv[++i]));
+    else if (arg == "--max-overhead" && hasValue) maxOverheadPct = std::atof(argv[++i]);
+    else if (arg == "--max-period" && hasValue) maxPeriodPct = std::atof(argv[++i]);
+    else {
+      std::cerr << "Usage: bench_metering [--blocks N] [--max-overhead PCT] [--max-period PCT]" << std::endl;
+      return 2;
+    }
+  }
+
+  std::vector<float> source((size_t)FRAMES * FILE_CHANNELS);
+  for (size_t i = 0; i < source.size(); i++) source[i] = (float)((i * 7919) % 2001) / 1000.0f - 1.0f;
+  std::vector<std::vector<float>> outputs(OUTPUTS, std::vector<float>(FRAMES));
+  std::vector<float> shape(FRAMES);
+  for (int n = 0; n < FRAMES; n++) shape[n] = (float)(n + 1) / FRAMES;
+  std::vector<float> peak(OUTPUTS), sumSquares(OUTPUTS);
+
+  output_gains gains;
+  gains.prepare(OUTPUTS, FRAMES);
+
+  // Alternate between two master gains so every block ramps (worst case)
+  float masterGain = 0.5f;
+  auto nextGain = [&]() { return masterGain = (masterGain == 0.5f) ? 0.6f : 0.5f; };
+
+  auto routeBlock = [&]() {
+    float g1 = nextGain();
+    float g0 = g1 == 0.5f ? 0.6f : 0.5f;
+    for (int ch = 0; ch < OUTPUTS; ch++) {
+      routeOnly(source.data() + ch, FILE_CHANNELS, outputs[ch].data(), FRAMES, g0, g1, shape.data());
+    }
+  };
+  auto fusedBlock = [&]() {
+    gains.beginBlock(nextGain(), FRAMES);
+    for (int ch = 0; ch < OUTPUTS; ch++) {
+      gains.route(ch, source.data() + ch, FILE_CHANNELS, outputs[ch].data(), FRAMES,
+                  peak[ch], sumSquares[ch]);
+    }
+  };
+  auto separateBlock = [&]() {
+    for (int ch = 0; ch < OUTPUTS; ch++) {
+      measureBlock(outputs[ch].data(), FRAMES, peak[ch], sumSquares[ch]);
+    }
+  };
+
+  // Interleaved rounds, best of each: frequency ramps and other load hit
+  // all three alike instead of skewing whichever ran first
+  const int ROUNDS = 5;
+  double baseline = 1e300, fused = 1e300, separate = 1e300;
+  for (int round = 0; round < ROUNDS; round++) {
+    baseline = std::min(baseline, nsPerBlock(blocks / ROUNDS + 1, routeBlock));
+    fused = std::min(fused, nsPerBlock(blocks / ROUNDS + 1, fusedBlock));
+    separate = std::min(separate, nsPerBlock(blocks / ROUNDS + 1, separateBlock));
+  }
+
+  double periodNs = FRAMES / SAMPLE_RATE * 1e9;
+  double overhead = std::max(fused - baseline, 0.0);
+  double overheadPct = baseline > 0.0 ? overhead / baseline * 100.0 : 0.0;
+  double separatePct = baseline > 0.0 ? separate / baseline * 100.0 : 0.0;
+  double periodPct = overhead / periodNs * 100.0;
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "Metering benchmark: " << OUTPUTS << " outputs x " << FRAMES << " frames, "
+            << blocks << " blocks" << std::endl;
+  std::cout << "  route only:          " << std::setw(9) << baseline << " ns/block" << std::endl;
+  std::cout << "  route + fused meter: " << std::setw(9) << fused << " ns/block" << std::endl;
+  std::cout << "  separate meter pass: " << std::setw(9) << separate << " ns/block" << std::endl;
+  std::cout << "  fused metering overhead: " << overhead << " ns/block = " << overheadPct
+            << "% of routing (a separate pass would add " << separatePct << "%)" << std::endl;
+  std::cout << std::setprecision(3) << "                           = " << periodPct << "% of the "
+            << std::setprecision(2) << periodNs / 1e6 << " ms callback period" << std::endl;
+
+  // Keep the results observable
+  float check = 0.0f;
+  for (int ch = 0; ch < OUTPUTS; ch++) check += peak[ch] + outputs[ch][FRAMES - 1];
+  if (check != check) std::cerr << "✗ NaN in benchmark output" << std::endl;
+
+  bool fusedOk = overhead <= separate;
+  bool routingOk = overheadPct <= maxOverheadPct;
+  bool periodOk = periodPct <= maxPeriodPct;
+  std::cout << std::setprecision(1);
+  std::cout << (fusedOk ? "✓ " : "✗ ") << "Fused metering " << (fusedOk ? "cheaper" : "more expensive")
+            << " than a separate pass" << std::endl;
+  std::cout << (routingOk ? "✓ " : "✗ ") << "Overhead vs routing " << overheadPct << "% (limit " << maxOverheadPct
+            << "%)" << std::endl;
+  std::cout << (periodOk ? "✓ " : "✗ ") << "Overhead vs callback period " << std::setprecision(3) << periodPct
+            << "% (limit " << std::setprecision(1) << maxPeriodPct << "%)" << std::endl;
+  return fusedOk && routingOk && periodOk ? 0 : 1;
+}
@@ -0,0 +1,353 @@
+/*
+  Render-path benchmark
+
+  Drives player_core::onSound with a standalone AudioIOData (no device) on a
+  synthetic multichannel WAV, through the real streaming reader, routing,
+  gain, metering and tap, optionally with EQ / bass management / limiter.
+  Every combination of
+    buffer size:    32 - 2048 frames
+    file channels:  16, 56, 60
+    routing:        allosphere (channelMapping.hpp), identity, upper ring
+  is timed per callback. Reported per combination:
+    ns/frame (mean), p99 callback time, TSC cycles per output sample
+    (x86 only), heap allocations on the audio thread per callback, and the
+    load at 48 kHz.
+
+  Blocks the streaming reader has not caught up with (the bench consumes
+  much faster than real time) are not timed; the bench waits and retries.
+
+  Results go to a CSV file as well. With --baseline, every combination is
+  compared with an earlier CSV: slower by more than --tolerance percent, or
+  any new allocation, counts as a regression and the exit status is 1.
+
+  Build: cmake --build build --target bench_player
+  Run:   ./build/bench_player [--blocks N] [--dsp] [--csv PATH]
+                              [--baseline PATH] [--tolerance PCT]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+#include "playerCore.hpp"
+
+// ---- Allocation counting (the benchmarking thread only) ----
+
+static thread_local bool countAllocations = false;
+static thread_local uint64_t allocationCount = 0;
+
+static void* countedAlloc(std::size_t size) {
+  if (countAllocations) allocationCount++;
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+static void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+  if (countAllocations) allocationCount++;
+  std::size_t a = std::max<std::size_t>((std::size_t)align, sizeof(void*));
+  if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return countedAlignedAlloc(size, align); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+static uint64_t cycles() {
+#ifdef BENCH_HAS_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// ---- Setup ----
+
+static const int OUTPUTS = 60;
+static const double SAMPLE_RATE = 48000.0;
+static const double FILE_SECONDS = 3.0;
+static const char* AUDIO_FOLDER = "bench_player_audio/";
+
+static const int BUFFER_SIZES[] = {32, 64, 128, 256, 512, 1024, 2048};
+static const int FILE_CHANNELS[] = {16, 56, 60};
+static const char* ROUTINGS[] = {"allosphere", "identity", "upper"};
+
+// Float WAV of decorrelated noise-like ramps, one per channel
+static bool writeSyntheticWav(const std::string& path, int channels) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) return false;
+  uint32_t frames = (uint32_t)(FILE_SECONDS * SAMPLE_RATE);
+  uint32_t dataBytes = frames * channels * 4, rate = (uint32_t)SAMPLE_RATE;
+  uint32_t riffBytes = 36 + dataBytes, fmtBytes = 16, byteRate = rate * channels * 4;
+  uint16_t format = 3, numChannels = (uint16_t)channels, blockAlign = (uint16_t)(channels * 4), bits = 32;
+  file.write("RIFF", 4).write((const char*)&riffBytes, 4).write("WAVEfmt ", 8).write((const char*)&fmtBytes, 4);
+  file.write((const char*)&format, 2).write((const char*)&numChannels, 2).write((const char*)&rate, 4);
+  file.write((const char*)&byteRate, 4).write((const char*)&blockAlign, 2).write((const char*)&bits, 2);
+  file.write("data", 4).write((const char*)&dataBytes, 4);
+  std::vector<float> frame(channels);
+  for (uint32_t n = 0; n < frames; n++) {
+    for (int ch = 0; ch < channels; ch++) {
+      frame[ch] = 0.25f * ((float)(((n + 1) * 7919u + ch * 104729u) % 2001u) / 1000.0f - 1.0f);
+    }
+    file.write((const char*)frame.data(), channels * 4);
+  }
+  return (bool)file;
+}
+
+static std::string wavName(int channels) { return "synthetic_" + std::to_string(channels) + "ch.wav"; }
+
+// Which file channel feeds each output
+static void applyRouting(player_core& player, const std::string& routing, int fileChannels) {
+  if (routing == "identity") {
+    for (int ch = 0; ch < OUTPUTS; ch++) player.outputSource[ch] = ch < fileChannels ? ch : -1;
+  } else if (routing == "upper") {
+    for (int ch = 0; ch < OUTPUTS; ch++) {
+      if (ChannelMapping::getRing(ch) != ChannelMapping::Ring::Upper) player.outputSource[ch] = -1;
+    }
+  }  // "allosphere": the player's own map
+}
+
+struct result {
+  int frames;
+  int fileChannels;
+  std::string routing;
+  bool dsp;
+  int blocks;
+  double nsPerFrame;
+  double p99Us;
+  double cyclesPerSample;
+  double allocationsPerBlock;
+  double loadPercent;
+
+  std::string key() const {
+    return std::to_string(frames) + "," + std::to_string(fileChannels) + "," + routing + "," + (dsp ? "1" : "0");
+  }
+};
+
+static bool runOne(int frames, int fileChannels, const std::string& routing, bool dsp, int blocks, result& out) {
+  // The player is chatty while it sets up (and the bench underruns on purpose)
+  std::streambuf* console = std::cout.rdbuf();
+  std::streambuf* errors = std::cerr.rdbuf();
+  std::ostringstream quiet;
+  std::cout.rdbuf(quiet.rdbuf());
+  std::cerr.rdbuf(quiet.rdbuf());
+  std::unique_ptr<player_core> player(new player_core());
+  player->audioBlockSize = frames;
+  player->stream.logSeconds = 0.0f;
+  player->stream.logWarnings = false;
+  player->setSourceAudioFolder(AUDIO_FOLDER);
+  player->setInitialFile(wavName(fileChannels));
+  player->onInit();
+  std::cout.rdbuf(console);
+  std::cerr.rdbuf(errors);
+  if (!player->soundFile.opened()) {
+    std::cerr << "✗ ERROR: Could not open " << AUDIO_FOLDER << wavName(fileChannels) << std::endl;
+    return false;
+  }
+  applyRouting(*player, routing, fileChannels);
+  player->eq.enabled.store(dsp);
+  player->bassManagement.enabled.store(dsp);
+  player->limiter.enabled.store(dsp);
+  player->playing = true;
+  player->loop = true;
+
+  AudioIOData io;
+  io.channelsOut(OUTPUTS);
+  io.framesPerBuffer(frames);
+  io.framesPerSecond(SAMPLE_RATE);
+
+  std::vector<double> blockNs;
+  blockNs.reserve(blocks);
+  uint64_t totalCycles = 0, allocations = 0;
+  int warmup = blocks / 10 + 8;
+  while ((int)blockNs.size() < blocks) {
+    uint64_t before = player->frameCounter;
+    uint64_t allocationsBefore = allocationCount;
+    io.frame(0);
+    countAllocations = true;
+    auto start = std::chrono::steady_clock::now();
+    uint64_t c0 = cycles();
+    player->onSound(io);
+    uint64_t c1 = cycles();
+    auto end = std::chrono::steady_clock::now();
+    countAllocations = false;
+    if (player->frameCounter == before) {
+      // Not buffered yet: give the reader time to refill the ring
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      continue;
+    }
+    if (warmup > 0) {
+      warmup--;
+      continue;
+    }
+    blockNs.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    totalCycles += c1 - c0;
+    allocations += allocationCount - allocationsBefore;
+  }
+  player->playing = false;
+
+  double meanNs = 0.0;
+  for (double ns : blockNs) meanNs += ns;
+  meanNs /= blocks;
+  std::sort(blockNs.begin(), blockNs.end());
+  double periodNs = frames / SAMPLE_RATE * 1e9;
+
+  out.frames = frames;
+  out.fileChannels = fileChannels;
+  out.routing = routing;
+  out.dsp = dsp;
+  out.blocks = blocks;
+  out.nsPerFrame = meanNs / frames;
+  out.p99Us = blockNs[std::min((size_t)(0.99 * blocks), blockNs.size() - 1)] * 1e-3;
+  out.cyclesPerSample = (double)totalCycles / blocks / ((double)frames * OUTPUTS);
+  out.allocationsPerBlock = (double)allocations / blocks;
+  out.loadPercent = meanNs / periodNs * 100.0;
+  return true;
+}
+
+static const char* CSV_HEADER =
+    "frames,file_channels,routing,dsp,blocks,ns_per_frame,p99_block_us,tsc_cycles_per_sample,"
+    "allocs_per_block,load_pct_48k";
+
+static bool writeCsv(const std::string& path, const std::vector<result>& results) {
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << "✗ ERROR: Could not write " << path << std::endl;
+    return false;
+  }
+  file << CSV_HEADER << "\n";
+  for (const result& r : results) {
+    file << r.key() << "," << r.blocks << "," << r.nsPerFrame << "," << r.p99Us << "," << r.cyclesPerSample << ","
+         << r.allocationsPerBlock << "," << r.loadPercent << "\n";
+  }
+  return true;
+}
+
+// key -> (ns/frame, allocations per block)
+static bool readBaseline(const std::string& path, std::map<std::string, std::pair<double, double>>& baseline) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "✗ ERROR: Could not read baseline " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  std::getline(file, line);  // Header
+  while (std::getline(file, line)) {
+    std::vector<std::string> fields;
+    std::stringstream row(line);
+    std::string field;
+    while (std::getline(row, field, ',')) fields.push_back(field);
+    if (fields.size() < 9) continue;
+    std::string key = fields[0] + "," + fields[1] + "," + fields[2] + "," + fields[3];
+    baseline[key] = {std::atof(fields[5].c_str()), std::atof(fields[8].c_str())};
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  int blocks = 2000;
+  bool dsp = false;
+  double tolerance = 15.0;
+  std::string csvPath = "bench_player.csv", baselinePath;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--blocks" && hasValue) blocks = std::max(10, std::atoi(argv[++i]));
+    else if (arg == "--dsp") dsp = true;
+    else if (arg == "--csv" && hasValue) csvPath = argv[++i];
+    else if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+    else if (arg == "--tolerance" && hasValue) tolerance = std::atof(argv[++i]);
+    else {
+      std::cerr << "Usage: bench_player [--blocks N] [--dsp] [--csv PATH] [--baseline PATH] [--tolerance PCT]"
+                << std::endl;
+      return 2;
+    }
+  }
+
+  std::map<std::string, std::pair<double, double>> baseline;
+  if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) return 2;
+
+  std::string folder = al::File::currentPath() + AUDIO_FOLDER;
+  std::filesystem::create_directories(folder);
+  for (int channels : FILE_CHANNELS) {
+    if (!writeSyntheticWav(folder + wavName(channels), channels)) {
+      std::cerr << "✗ ERROR: Could not write synthetic audio to " << folder << std::endl;
+      return 2;
+    }
+  }
+
+  std::cout << "Render-path benchmark: " << OUTPUTS << " outputs, " << blocks << " callbacks per run"
+            << (dsp ? ", EQ + bass management + limiter on" : "") << std::endl;
+#ifndef BENCH_HAS_TSC
+  std::cout << "  (no TSC on this CPU: cycles/sample reported as 0)" << std::endl;
+#endif
+  std::cout << "  frames  ch  routing      ns/frame  p99 us  cyc/smp  allocs  load@48k" << std::endl;
+
+  std::vector<result> results;
+  int regressions = 0;
+  for (int channels : FILE_CHANNELS) {
+    for (const char* routing : ROUTINGS) {
+      for (int frames : BUFFER_SIZES) {
+        result r;
+        if (!runOne(frames, channels, routing, dsp, blocks, r)) return 2;
+        results.push_back(r);
+        std::cout << std::fixed << "  " << std::setw(6) << frames << std::setw(4) << channels << "  "
+                  << std::left << std::setw(11) << routing << std::right << std::setprecision(1)
+                  << std::setw(10) << r.nsPerFrame << std::setw(8) << r.p99Us << std::setprecision(2)
+                  << std::setw(9) << r.cyclesPerSample << std::setw(8) << r.allocationsPerBlock
+                  << std::setprecision(1) << std::setw(8) << r.loadPercent << "%";
+
+        auto base = baseline.find(r.key());
+        if (base != baseline.end()) {
+          double change = (r.nsPerFrame / base->second.first - 1.0) * 100.0;
+          bool slower = change > tolerance;
+          bool allocates = r.allocationsPerBlock > base->second.second;
+          if (slower || allocates) regressions++;
+          std::cout << std::showpos << std::setprecision(1) << "  " << change << "%" << std::noshowpos
+                    << (slower ? "  ⚠ slower" : "") << (allocates ? "  ⚠ allocates" : "");
+        }
+        std::cout << std::endl;
+      }
+    }
+  }
+
+  if (!writeCsv(csvPath, results)) return 2;
+  std::cout << "✓ Results written to " << csvPath << std::endl;
+  std::filesystem::remove_all(folder);
+
+  for (const result& r : results) {
+    if (r.allocationsPerBlock > 0.0) {
+      std::cout << "⚠ The audio thread allocates (" << r.key() << ")" << std::endl;
+      break;
+    }
+  }
+  if (!baseline.empty()) {
+    std::cout << (regressions ? "⚠ " : "✓ ") << regressions << " regression(s) against " << baselinePath
+              << " (tolerance " << tolerance << "%)" << std::endl;
+  }
+  return regressions ? 1 : 0;
+}
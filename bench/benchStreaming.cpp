@@ -0,0 +1,331 @@
+/*
+  Streaming I/O benchmark
+
+  Replays a playback timeline through the streaming reader (streamReader.hpp)
+  in real time, for every combination of
+    file format: 56-channel float32 / PCM24 / PCM16 WAV (synthetic, --seconds long)
+    disk:        a stand-in source that adds read latency, stalls and a
+                 throughput cap on top of the real file reads
+  Timeline: open, play 2 s, seek to 0.5 s before the end and play 1.5 s
+  (through the loop point), seek to the middle and play 1 s, switch to a
+  second file and play 1.5 s. The bench thread plays the audio thread:
+  one fetch() per block period, silence when nothing is buffered.
+
+  Reported per combination:
+    startup   open() until the first block is audible (ms)
+    seek      longest jump / file switch until audio resumes (ms)
+    underruns blocks lost to a ring that ran dry (not counting refills
+              after a jump), and near-underruns (fill below 250 ms)
+    fill      lowest fill level while playing (ms)
+    read p99  per-read latency seen by the reader (ms)
+    RSS       peak resident memory above the level before the run (MB)
+
+  Build: cmake --build build --target bench_streaming
+  Run:   ./build/bench_streaming [--seconds N] [--block N] [--csv PATH]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <vector>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#else
+#include <malloc.h>
+#include <unistd.h>
+#endif
+#include "streamReader.hpp"
+
+using clock_type = std::chrono::steady_clock;
+
+static const int CHANNELS = 56;
+static const double SAMPLE_RATE = 48000.0;
+
+// ---- Disk stand-in ----
+
+struct disk_profile {
+  const char* name;
+  float latencyMs;    // Added to every read (seek + access time)
+  float mbPerSecond;  // Throughput cap (0 = uncapped)
+  int stallEvery;     // Every Nth read also stalls (0 = never)
+  float stallMs;
+};
+
+static const disk_profile DISKS[] = {
+    {"local", 0.0f, 0.0f, 0, 0.0f},
+    {"hdd", 8.0f, 80.0f, 0, 0.0f},
+    {"network", 20.0f, 30.0f, 100, 400.0f},
+    {"starved", 2.0f, 8.0f, 0, 0.0f},  // Below what float32 playback needs (10.8 MB/s)
+};
+
+// gam::SoundFile with the profile's cost applied after each real read
+struct throttled_file {
+  disk_profile profile = DISKS[0];
+
+  bool openRead(const std::string& path) {
+    if (!file.openRead(path)) return false;
+    std::error_code error;
+    uintmax_t bytes = std::filesystem::file_size(path, error);
+    bytesPerFrame = (!error && file.frames() > 0) ? (double)bytes / file.frames() : file.channels() * 4.0;
+    reads = 0;
+    return true;
+  }
+  void close() { file.close(); }
+  int channels() const { return file.channels(); }
+  int frames() const { return file.frames(); }
+  double frameRate() const { return file.frameRate(); }
+  int seek(int position, int whence) { return file.seek(position, whence); }
+
+  int read(float* data, int frames) {
+    clock_type::time_point start = clock_type::now();
+    int got = file.read(data, frames);
+    double ms = profile.latencyMs;
+    if (profile.mbPerSecond > 0.0f) ms += got * bytesPerFrame / (profile.mbPerSecond * 1e6) * 1000.0;
+    if (profile.stallEvery > 0 && ++reads % profile.stallEvery == 0) ms += profile.stallMs;
+    std::this_thread::sleep_until(start + std::chrono::microseconds((int64_t)(ms * 1000.0)));
+    return got;
+  }
+
+private:
+  gam::SoundFile file;
+  double bytesPerFrame = 0.0;
+  uint64_t reads = 0;
+};
+
+// ---- Synthetic files ----
+
+struct file_format {
+  const char* name;
+  uint16_t tag;  // WAVE_FORMAT_PCM = 1, WAVE_FORMAT_IEEE_FLOAT = 3
+  uint16_t bits;
+};
+
+static const file_format FORMATS[] = {{"float32", 3, 32}, {"pcm24", 1, 24}, {"pcm16", 1, 16}};
+
+static bool writeSyntheticWav(const std::string& path, const file_format& format, double seconds, int seed) {
+  std::ofstream file(path, std::ios::binary);
+  if (!file) return false;
+  uint32_t frames = (uint32_t)(seconds * SAMPLE_RATE), rate = (uint32_t)SAMPLE_RATE;
+  uint16_t bytes = format.bits / 8, blockAlign = (uint16_t)(CHANNELS * bytes), numChannels = CHANNELS;
+  uint32_t dataBytes = frames * blockAlign, riffBytes = 36 + dataBytes, fmtBytes = 16, byteRate = rate * blockAlign;
+  file.write("RIFF", 4).write((const char*)&riffBytes, 4).write("WAVEfmt ", 8).write((const char*)&fmtBytes, 4);
+  file.write((const char*)&format.tag, 2).write((const char*)&numChannels, 2).write((const char*)&rate, 4);
+  file.write((const char*)&byteRate, 4).write((const char*)&blockAlign, 2).write((const char*)&format.bits, 2);
+  file.write("data", 4).write((const char*)&dataBytes, 4);
+
+  const uint32_t chunk = 4096;
+  std::vector<char> block((size_t)chunk * blockAlign);
+  for (uint32_t start = 0; start < frames; start += chunk) {
+    uint32_t n = std::min(chunk, frames - start);
+    char* out = block.data();
+    for (uint32_t f = 0; f < n; f++) {
+      for (int ch = 0; ch < CHANNELS; ch++) {
+        float v = 0.25f * ((float)(((start + f + 1) * 7919u + (ch + seed) * 104729u) % 2001u) / 1000.0f - 1.0f);
+        if (format.tag == 3) {
+          std::memcpy(out, &v, 4);
+        } else {
+          int32_t s = (int32_t)(v * (float)((1 << (format.bits - 1)) - 1));
+          std::memcpy(out, &s, bytes);  // Little-endian: the low bytes
+        }
+        out += bytes;
+      }
+    }
+    file.write(block.data(), (std::streamsize)n * blockAlign);
+  }
+  return (bool)file;
+}
+
+// ---- Measurement ----
+
+static double residentMB() {
+#ifdef __APPLE__
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) return 0.0;
+  return info.resident_size / 1e6;
+#else
+  long pages = 0, resident = 0;
+  FILE* statm = std::fopen("/proc/self/statm", "r");
+  if (!statm) return 0.0;
+  if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+  std::fclose(statm);
+  return resident * (double)sysconf(_SC_PAGESIZE) / 1e6;
+#endif
+}
+
+// Heap the previous run freed goes back to the OS, so runs start level
+static void releaseFreedMemory() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+}
+
+struct result {
+  std::string format;
+  std::string disk;
+  double startupMs = 0.0;
+  double maxSeekMs = 0.0;
+  uint64_t underruns = 0;
+  uint64_t nearUnderruns = 0;
+  float minFillMs = 1e30f;
+  float readP99Ms = 0.0f;
+  double peakRssMB = 0.0;
+};
+
+// Plays the bench thread's part of the audio callback, in real time
+struct playback {
+  basic_stream_reader<throttled_file>& stream;
+  result& r;
+  int block;
+  std::vector<float> scratch;
+  uint64_t position = 0;
+  clock_type::time_point next = clock_type::now();
+  clock_type::time_point jumpStart;
+  bool waitingForAudio = false;
+  double baseRss;
+
+  playback(basic_stream_reader<throttled_file>& s, result& res, int blockFrames, double rss)
+      : stream(s), r(res), block(blockFrames), scratch((size_t)blockFrames * CHANNELS), baseRss(rss) {}
+
+  // Playhead moved (open, seek, switch): time until audio resumes
+  void jump(uint64_t to) {
+    position = to;
+    jumpStart = clock_type::now();
+    waitingForAudio = true;
+  }
+
+  void play(double seconds) {
+    std::chrono::nanoseconds period((int64_t)(block / SAMPLE_RATE * 1e9));
+    int blocks = (int)(seconds * SAMPLE_RATE / block);
+    for (int b = 0; b < blocks; b++) {
+      if (position >= stream.frames()) position = 0;  // Loop
+      int n = (int)std::min<uint64_t>(block, stream.frames() - position);
+      if (stream.fetch(position, n, scratch.data())) {
+        position += n;
+        if (waitingForAudio) {
+          double ms = std::chrono::duration<double, std::milli>(clock_type::now() - jumpStart).count();
+          if (r.startupMs == 0.0) r.startupMs = ms;
+          else r.maxSeekMs = std::max(r.maxSeekMs, ms);
+          waitingForAudio = false;
+        }
+      }
+      if (b % 32 == 0) r.peakRssMB = std::max(r.peakRssMB, residentMB() - baseRss);
+      next += period;
+      std::this_thread::sleep_until(next);
+    }
+  }
+
+  // open() without its console line (errors still go to std::cerr)
+  bool open(const std::string& path) {
+    std::streambuf* console = std::cout.rdbuf();
+    std::ostringstream quiet;
+    std::cout.rdbuf(quiet.rdbuf());
+    bool ok = stream.open(path);
+    std::cout.rdbuf(console);
+    return ok;
+  }
+
+  // Counters restart at every open(): fold them in before a switch / at the end
+  void collect() {
+    r.underruns += stream.underrunCount();
+    r.nearUnderruns += stream.nearUnderrunCount();
+    if (stream.minFillMs() > 0.0f) r.minFillMs = std::min(r.minFillMs, stream.minFillMs());
+    r.readP99Ms = std::max(r.readP99Ms, stream.readPercentileMs(0.99f));
+  }
+};
+
+static result runTimeline(const std::string& fileA, const std::string& fileB, const file_format& format,
+                          const disk_profile& disk, int block) {
+  result r;
+  r.format = format.name;
+  r.disk = disk.name;
+  releaseFreedMemory();
+  double baseRss = residentMB();
+
+  basic_stream_reader<throttled_file> stream;
+  stream.logSeconds = 0.0f;
+  stream.logWarnings = false;
+  stream.source().profile = disk;
+  playback player(stream, r, block, baseRss);
+
+  player.jump(0);
+  if (!player.open(fileA)) return r;
+  player.play(2.0);
+
+  player.jump(stream.frames() - (uint64_t)(0.5 * SAMPLE_RATE));
+  player.play(1.5);
+
+  player.jump(stream.frames() / 2);
+  player.play(1.0);
+
+  player.collect();
+  player.jump(0);
+  if (!player.open(fileB)) return r;
+  player.play(1.5);
+  player.collect();
+  stream.close();
+  if (r.minFillMs == 1e30f) r.minFillMs = 0.0f;
+  return r;
+}
+
+int main(int argc, char* argv[]) {
+  double seconds = 10.0;
+  int block = 512;
+  std::string csvPath = "bench_streaming.csv";
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--seconds" && hasValue) seconds = std::max(4.0, std::atof(argv[++i]));
+    else if (arg == "--block" && hasValue) block = std::max(16, std::atoi(argv[++i]));
+    else if (arg == "--csv" && hasValue) csvPath = argv[++i];
+    else {
+      std::cerr << "Usage: bench_streaming [--seconds N] [--block N] [--csv PATH]" << std::endl;
+      return 2;
+    }
+  }
+
+  std::filesystem::path folder = std::filesystem::temp_directory_path() / "bench_streaming_audio";
+  std::filesystem::create_directories(folder);
+  rtLog();  // Formatter thread up before the first fetch()
+
+  std::cout << "Streaming benchmark: " << CHANNELS << " channels, " << seconds << " s files, " << block
+            << "-frame blocks, 2 s prefetch" << std::endl;
+  std::cout << "  format   disk      startup ms  seek ms  underruns  near  min fill ms  read p99 ms  RSS MB"
+            << std::endl;
+
+  std::ofstream csv(csvPath);
+  csv << "format,disk,startup_ms,max_seek_ms,underruns,near_underruns,min_fill_ms,read_p99_ms,peak_rss_mb\n";
+  for (const file_format& format : FORMATS) {
+    std::string fileA = (folder / (std::string("a_") + format.name + ".wav")).string();
+    std::string fileB = (folder / (std::string("b_") + format.name + ".wav")).string();
+    if (!writeSyntheticWav(fileA, format, seconds, 0) || !writeSyntheticWav(fileB, format, seconds, 1)) {
+      std::cerr << "✗ ERROR: Could not write synthetic audio to " << folder << std::endl;
+      return 2;
+    }
+    for (const disk_profile& disk : DISKS) {
+      result r = runTimeline(fileA, fileB, format, disk, block);
+      std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(9) << r.format
+                << std::setw(10) << r.disk << std::right << std::setw(10) << r.startupMs << std::setw(9)
+                << r.maxSeekMs << std::setw(11) << r.underruns << std::setw(6) << r.nearUnderruns
+                << std::setw(13) << r.minFillMs << std::setprecision(2) << std::setw(13) << r.readP99Ms
+                << std::setprecision(1) << std::setw(8) << r.peakRssMB << (r.underruns ? "  ⚠" : "") << std::endl;
+      csv << r.format << "," << r.disk << "," << r.startupMs << "," << r.maxSeekMs << "," << r.underruns << ","
+          << r.nearUnderruns << "," << r.minFillMs << "," << r.readP99Ms << "," << r.peakRssMB << "\n";
+    }
+    std::filesystem::remove(fileA);
+    std::filesystem::remove(fileB);
+  }
+  std::filesystem::remove_all(folder);
+  std::cout << "✓ Results written to " << csvPath << std::endl;
+  return 0;
+}
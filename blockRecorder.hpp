@@ -0,0 +1,246 @@
+/*
+  Block recorder: what went to the outputs (or came in on the inputs), to a
+  WAV / BW64 file
+
+  onSound hands every block to write(): it is interleaved into a
+  preallocated ring and the audio thread moves on. A writer thread takes
+  the ring out in CHUNK_FRAMES pieces (whole pages: the ring is page
+  aligned and bw64Writer.hpp puts the samples at a page boundary) and
+  writes them to disk.
+
+  The audio thread never waits for the disk. If the ring is full (the disk
+  stalled for longer than ringSeconds) the block is dropped and counted as
+  an overrun; the file then has a gap there, which the counters and the
+  log make visible. Everything else is lock-free single-writer counters.
+
+  Start / stop come from the GUI or control thread. The audio thread
+  acknowledges both at its next block, so the file holds whole blocks only
+  and the writer knows when the last one is in. Each recording has its own
+  session number and every acknowledgement names one: when stop() gives up
+  waiting (audio not running), a late acknowledgement from the audio thread
+  can't end or skip the start of the next recording.
+*/
+
+#ifndef BLOCK_RECORDER_HPP
+#define BLOCK_RECORDER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "al/io/al_AudioIOData.hpp"
+#include "bw64Writer.hpp"
+#include "rtLog.hpp"
+#include "traceRecorder.hpp"
+
+struct block_recorder {
+  enum Source { OUTPUTS, INPUTS };
+  static constexpr int CHUNK_FRAMES = 4096;  // Frames per disk write (a multiple of 4 KiB for any channel count)
+
+  float ringSeconds = 4.0f;            // Disk stall the recorder rides out, applied at prepare()
+  float preallocateMinutes = 0.0f;     // Space reserved at start() (0 = none)
+  bw64_writer::Format format = bw64_writer::FLOAT32;
+
+  // Allocate the ring (room for the wider of outputs and inputs). Must be
+  // called before audio starts.
+  void prepare(int numOutputs, int numInputs, double sampleRate) {
+    stop();
+    outputChannels = numOutputs;
+    inputChannels = numInputs;
+    channels = std::max(numOutputs, numInputs);
+    rate = sampleRate;
+    uint64_t chunks = std::max<uint64_t>(2, (uint64_t)std::ceil(ringSeconds * rate / CHUNK_FRAMES));
+    capacity = chunks * CHUNK_FRAMES;
+    size_t bytes = (size_t)capacity * channels * sizeof(float);
+    ring.reset(static_cast<float*>(std::aligned_alloc(PAGE_BYTES, (bytes + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES)));
+    std::fill(ring.get(), ring.get() + (size_t)capacity * channels, 0.0f);
+  }
+
+  // ---- Audio thread ----
+
+  // Record the first `frames` frames of the output (or input) buffers
+  void write(const al::AudioIOData& io, int frames) {
+    uint32_t want = requested.load(std::memory_order_acquire);
+    if (want != activeSession) {
+      // Straight from one session to the next if stop() went ahead without us
+      if (want != 0) {
+        startedSession.store(want, std::memory_order_release);
+      } else {
+        stoppedSession.store(activeSession, std::memory_order_release);
+      }
+      activeSession = want;
+    }
+    if (activeSession == 0 || !ring) return;
+
+    uint64_t w = writeIndex.load(std::memory_order_relaxed);
+    uint64_t r = readIndex.load(std::memory_order_acquire);
+    if (capacity - (w - r) < (uint64_t)frames) {
+      uint64_t count = overruns.load(std::memory_order_relaxed) + 1;
+      overruns.store(count, std::memory_order_relaxed);
+      droppedFrames.store(droppedFrames.load(std::memory_order_relaxed) + frames, std::memory_order_relaxed);
+      TRACE_INSTANT("recorder overrun");
+      if (!overrunning) rtLog().error("✗ Recorder overrun: disk too slow, dropped blocks ({} total)", count);
+      overrunning = true;
+      return;
+    }
+    overrunning = false;
+
+    bool inputs = source == INPUTS;
+    int available = std::min(channels, inputs ? io.channelsIn() : io.channelsOut());
+    for (int done = 0; done < frames;) {
+      uint64_t position = (w + done) % capacity;
+      int n = (int)std::min<uint64_t>(frames - done, capacity - position);  // Up to the end of the ring
+      float* dst = ring.get() + position * channels;
+      for (int ch = 0; ch < channels; ch++) {
+        const float* src = ch < available ? (inputs ? io.inBuffer(ch) : io.outBuffer(ch)) + done : nullptr;
+        for (int f = 0; f < n; f++) dst[(size_t)f * channels + ch] = src ? src[f] : 0.0f;
+      }
+      done += n;
+    }
+    writeIndex.store(w + frames, std::memory_order_release);
+    uint64_t fill = w + frames - r;
+    if (fill > peakFill.load(std::memory_order_relaxed)) peakFill.store(fill, std::memory_order_relaxed);
+  }
+
+  // ---- Control (GUI / control thread) ----
+
+  bool start(const std::string& path, Source what = OUTPUTS) {
+    stop();  // Also collects a writer that ended on a failed write
+    if (!ring) {
+      std::cerr << "✗ ERROR: Recorder not prepared" << std::endl;
+      return false;
+    }
+    int fileChannels = what == INPUTS ? inputChannels : outputChannels;
+    if (fileChannels <= 0) {
+      std::cerr << "✗ ERROR: No " << (what == INPUTS ? "inputs" : "outputs") << " to record" << std::endl;
+      return false;
+    }
+    channels = fileChannels;  // Frame width in the ring for this recording
+    source = what;
+    if (!file.open(path, channels, rate, format)) return false;
+    if (preallocateMinutes > 0.0f) {
+      uint64_t bytes = (uint64_t)(preallocateMinutes * 60.0 * rate) * file.bytesPerFrame();
+      if (!file.preallocate(bytes)) {
+        std::cerr << "⚠ WARNING: Could not preallocate " << bytes / 1000000 << " MB for the recording" << std::endl;
+      }
+    }
+    filePath = path;
+    writeIndex.store(0);
+    readIndex.store(0);
+    overruns.store(0);
+    droppedFrames.store(0);
+    peakFill.store(0);
+    writeFailed.store(false);
+    overrunning = false;
+    session = session % UINT32_MAX + 1;  // Never 0 (= not recording)
+    writer = std::thread([this, s = session] { writerLoop(s); });
+    requested.store(session, std::memory_order_release);
+    std::cout << "● Recording " << channels << (source == INPUTS ? " inputs" : " outputs") << " to " << path
+              << std::endl;
+    return true;
+  }
+
+  // Stop after the current block and finish the file. If the audio
+  // thread is not running, recording stops where it is.
+  bool stop() {
+    if (!writer.joinable()) return true;
+    requested.store(0, std::memory_order_release);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (startedSession.load(std::memory_order_acquire) == session &&
+           stoppedSession.load(std::memory_order_acquire) != session &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    stoppedSession.store(session, std::memory_order_release);  // Also releases the writer if audio never ran
+    writer.join();
+    bool ok = file.close() && !writeFailed.load();
+    if (ok) {
+      std::cout << "✓ Recorded " << recordedSeconds() << " s to " << filePath << " (" << overrunCount()
+                << " overruns)" << std::endl;
+    } else {
+      std::cerr << "✗ ERROR: Recording failed: " << filePath << std::endl;
+    }
+    return ok;
+  }
+
+  ~block_recorder() { stop(); }
+
+  // ---- Stats (any thread) ----
+
+  bool recording() const { return requested.load(std::memory_order_relaxed) != 0; }
+  Source recordingSource() const { return source; }
+  const std::string& path() const { return filePath; }
+  double recordedSeconds() const { return rate > 0.0 ? readIndex.load(std::memory_order_relaxed) / rate : 0.0; }
+  uint64_t overrunCount() const { return overruns.load(std::memory_order_relaxed); }
+  double droppedSeconds() const { return rate > 0.0 ? droppedFrames.load(std::memory_order_relaxed) / rate : 0.0; }
+  // Ring use now and at its highest, 0-1
+  float ringFill() const {
+    uint64_t w = writeIndex.load(std::memory_order_relaxed), r = readIndex.load(std::memory_order_relaxed);
+    return capacity > 0 ? (float)(w - std::min(w, r)) / capacity : 0.0f;
+  }
+  float peakRingFill() const { return capacity > 0 ? (float)peakFill.load(std::memory_order_relaxed) / capacity : 0.0f; }
+
+private:
+  static constexpr size_t PAGE_BYTES = 4096;
+
+  struct free_deleter {
+    void operator()(float* p) const { std::free(p); }
+  };
+
+  int outputChannels = 0;
+  int inputChannels = 0;
+  int channels = 0;       // Of the current recording
+  Source source = OUTPUTS;
+  double rate = 48000.0;
+  uint64_t capacity = 0;  // Frames, a multiple of CHUNK_FRAMES
+  std::unique_ptr<float, free_deleter> ring;
+  bw64_writer file;
+  std::string filePath;
+  std::thread writer;
+  uint32_t session = 0;  // Control thread: the current / last recording
+
+  std::atomic<uint64_t> writeIndex{0};      // Frames, audio thread
+  std::atomic<uint64_t> readIndex{0};       // Frames, writer thread
+  std::atomic<uint32_t> requested{0};       // Control thread: session to record (0 = none)
+  std::atomic<uint32_t> startedSession{0};  // Audio thread: first block of this session recorded
+  std::atomic<uint32_t> stoppedSession{0};  // Audio thread: last block of this session recorded
+  std::atomic<bool> writeFailed{false};
+  std::atomic<uint64_t> overruns{0};
+  std::atomic<uint64_t> droppedFrames{0};
+  std::atomic<uint64_t> peakFill{0};
+  uint32_t activeSession = 0;  // Audio thread (0 = not recording)
+  bool overrunning = false;    // Audio thread: overrun already logged
+
+  void writerLoop(uint32_t s) {
+    TRACE_THREAD("recorder writer");
+    for (;;) {
+      bool last = stoppedSession.load(std::memory_order_acquire) == s;  // Before reading writeIndex: nothing follows it
+      uint64_t r = readIndex.load(std::memory_order_relaxed);
+      uint64_t available = writeIndex.load(std::memory_order_acquire) - r;
+      if (available < (uint64_t)CHUNK_FRAMES && !(last && available > 0)) {
+        if (last) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        continue;
+      }
+      // Whole chunks (page multiples); the tail only once recording has stopped
+      int n = (int)std::min<uint64_t>(available, CHUNK_FRAMES);
+      {
+        TRACE_SCOPE("recorder write");
+        if (!file.write(ring.get() + (r % capacity) * channels, n)) {
+          writeFailed.store(true);
+          requested.store(0);
+          return;
+        }
+      }
+      readIndex.store(r + n, std::memory_order_release);
+    }
+  }
+};
+
+#endif // BLOCK_RECORDER_HPP
@@ -0,0 +1,183 @@
+/*
+  Multichannel WAV / BW64 file writer
+
+  Writes interleaved float frames to a WAV file as 32-bit float or 24-bit
+  PCM. A 60-channel float file passes the 4 GB RIFF limit after about six
+  minutes at 48 kHz, so the header reserves room for a ds64 chunk (a JUNK
+  chunk of the same size, ignored by WAV readers). close() patches the
+  sizes in: a file under 4 GB stays a plain RIFF/WAVE, a larger one becomes
+  BW64 (ITU-R BS.2088: "BW64" id, 64-bit sizes in ds64, 32-bit fields set
+  to 0xFFFFFFFF).
+
+  The sample data starts at DATA_OFFSET (4 KiB, padded with a second JUNK
+  chunk), so writes of whole pages from page-aligned memory land on page
+  boundaries in the file. preallocate() reserves disk space up front
+  (fallocate on Linux) so a long recording does not hit allocation stalls
+  or run out of space halfway; close() trims what was not used.
+
+  Not real-time safe: write() is a blocking system call. Call it from a
+  writer thread fed by a ring, not from onSound.
+*/
+
+#ifndef BW64_WRITER_HPP
+#define BW64_WRITER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/types.h>
+#include <unistd.h>
+#include <vector>
+
+struct bw64_writer {
+  enum Format { FLOAT32, PCM24 };
+  static constexpr uint64_t DATA_OFFSET = 4096;
+
+  ~bw64_writer() { close(); }
+
+  bool open(const std::string& filePath, int numChannels, double sampleRate, Format sampleFormat = FLOAT32) {
+    close();
+    fd = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      std::cerr << "✗ ERROR: Could not create output file: " << filePath << " (" << std::strerror(errno) << ")"
+                << std::endl;
+      return false;
+    }
+    path = filePath;
+    channels = numChannels;
+    rate = sampleRate;
+    format = sampleFormat;
+    frames = 0;
+    failed = false;
+    std::vector<uint8_t> header = buildHeader(0);
+    writeAll(header.data(), header.size());
+    return !failed;
+  }
+
+  // Reserve space for this many bytes of samples (false if not supported)
+  bool preallocate(uint64_t dataBytes) {
+    if (fd < 0) return false;
+#ifdef __linux__
+    return fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)(DATA_OFFSET + dataBytes)) == 0;
+#else
+    (void)dataBytes;
+    return false;
+#endif
+  }
+
+  // Append interleaved frames (frames x channels floats)
+  bool write(const float* interleaved, int numFrames) {
+    if (fd < 0 || failed) return false;
+    size_t samples = (size_t)numFrames * channels;
+    if (format == FLOAT32) {
+      writeAll(interleaved, samples * sizeof(float));
+    } else {
+      packed.resize(samples * 3);
+      for (size_t i = 0; i < samples; i++) {
+        float v = std::min(std::max(interleaved[i], -1.0f), 1.0f);
+        int32_t s = (int32_t)std::lrint(v * 8388607.0f);
+        packed[i * 3] = (uint8_t)s;
+        packed[i * 3 + 1] = (uint8_t)(s >> 8);
+        packed[i * 3 + 2] = (uint8_t)(s >> 16);
+      }
+      writeAll(packed.data(), packed.size());
+    }
+    if (failed) std::cerr << "✗ ERROR: Write failed (" << std::strerror(errno) << "): " << path << std::endl;
+    frames += numFrames;
+    return !failed;
+  }
+
+  // Patch the chunk sizes, drop unused preallocation and close; true if
+  // every write succeeded
+  bool close() {
+    if (fd < 0) return true;
+    uint64_t dataBytes = frames * bytesPerFrame();
+    if (!failed) {
+      if (dataBytes & 1) {
+        uint8_t pad = 0;  // Chunks are word aligned
+        writeAll(&pad, 1);
+      }
+      std::vector<uint8_t> header = buildHeader(dataBytes);
+      failed |= ::pwrite(fd, header.data(), header.size(), 0) != (ssize_t)header.size();
+      failed |= ::ftruncate(fd, (off_t)(DATA_OFFSET + dataBytes + (dataBytes & 1))) != 0;
+    }
+    bool ok = ::close(fd) == 0 && !failed;
+    fd = -1;
+    return ok;
+  }
+
+  bool isOpen() const { return fd >= 0; }
+  uint64_t framesWritten() const { return frames; }
+  uint64_t bytesPerFrame() const { return (uint64_t)channels * (format == FLOAT32 ? 4 : 3); }
+
+private:
+  static constexpr uint32_t DS64_BYTES = 28;
+  static constexpr uint32_t FMT_BYTES = 16;
+  static constexpr uint32_t PAD_BYTES = (uint32_t)DATA_OFFSET - (12 + (8 + DS64_BYTES) + (8 + FMT_BYTES) + 8 + 8);
+
+  int fd = -1;
+  std::string path;
+  int channels = 0;
+  double rate = 0.0;
+  Format format = FLOAT32;
+  uint64_t frames = 0;
+  bool failed = false;
+  std::vector<uint8_t> packed;  // PCM24 conversion scratch
+
+  // RIFF / BW64 header up to the first sample (DATA_OFFSET bytes)
+  std::vector<uint8_t> buildHeader(uint64_t dataBytes) const {
+    std::vector<uint8_t> h;
+    h.reserve(DATA_OFFSET);
+    auto id = [&](const char* s) { h.insert(h.end(), s, s + 4); };
+    auto u16 = [&](uint16_t v) { h.push_back((uint8_t)v), h.push_back((uint8_t)(v >> 8)); };
+    auto u32 = [&](uint32_t v) { u16((uint16_t)v), u16((uint16_t)(v >> 16)); };
+    auto u64 = [&](uint64_t v) { u32((uint32_t)v), u32((uint32_t)(v >> 32)); };
+
+    uint64_t riffBytes = DATA_OFFSET - 8 + dataBytes + (dataBytes & 1);
+    bool large = riffBytes > 0xFFFFFFFFull;
+    id(large ? "BW64" : "RIFF");
+    u32(large ? 0xFFFFFFFFu : (uint32_t)riffBytes);
+    id("WAVE");
+    id(large ? "ds64" : "JUNK");  // Reserved until the file passes 4 GB
+    u32(DS64_BYTES);
+    u64(large ? riffBytes : 0);
+    u64(large ? dataBytes : 0);
+    u64(large ? frames : 0);
+    u32(0);  // No table entries
+    id("fmt ");
+    u32(FMT_BYTES);
+    u16(format == FLOAT32 ? 3 : 1);  // WAVE_FORMAT_IEEE_FLOAT / WAVE_FORMAT_PCM
+    u16((uint16_t)channels);
+    u32((uint32_t)rate);
+    u32((uint32_t)(rate * bytesPerFrame()));
+    u16((uint16_t)bytesPerFrame());
+    u16(format == FLOAT32 ? 32 : 24);
+    id("JUNK");  // Pads the samples to DATA_OFFSET
+    u32(PAD_BYTES);
+    h.resize(h.size() + PAD_BYTES, 0);
+    id("data");
+    u32(large ? 0xFFFFFFFFu : (uint32_t)dataBytes);
+    return h;
+  }
+
+  void writeAll(const void* data, size_t bytes) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (bytes > 0 && !failed) {
+      ssize_t n = ::write(fd, p, bytes);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        failed = true;
+        return;
+      }
+      p += n;
+      bytes -= (size_t)n;
+    }
+  }
+};
+
+#endif // BW64_WRITER_HPP
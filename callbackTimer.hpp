@@ -0,0 +1,197 @@
+/*
+  Audio callback timing
+
+  onSound marks the end of each stage as it goes (read / stream, routing,
+  silence fill, correction, channel DSP, metering); callback_timer turns the
+  marks into:
+  - per-stage time, summed since the last reset (average per callback)
+  - DSP load: callback duration / buffer period, smoothed and maximum
+  - CPU headroom: 1 - load of the last callback, measured at its end, and
+    the minimum since the last reset
+  - a histogram of callback durations, 0 - 2 buffer periods in 64 bins
+  - late callbacks (ran longer than the buffer period) and underruns (the
+    next callback started more than 1.5 periods after the previous one:
+    the device ran dry, whatever the reason)
+
+  The audio thread is the only writer: counters are plain relaxed atomic
+  stores, no read-modify-write, no locks. The GUI reads them any time;
+  reset is requested by the GUI and carried out by the audio thread at the
+  start of its next callback.
+
+  With tracing on (traceRecorder.hpp) the same marks become trace events:
+  one per stage, one per callback, instants for late callbacks / underruns.
+*/
+
+#ifndef CALLBACK_TIMER_HPP
+#define CALLBACK_TIMER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "traceRecorder.hpp"
+
+struct callback_timer {
+  enum Stage { STREAM, ROUTE, SILENCE, CORRECTION, CHANNEL_DSP, METERING, NUM_STAGES };
+  static constexpr const char* STAGE_NAMES[NUM_STAGES] = {"Read / stream", "Routing", "Silence fill",
+                                                          "Correction", "EQ / bass / limiter", "Metering / tap"};
+  static constexpr int HISTOGRAM_BINS = 64;       // Bin width = period / BINS_PER_PERIOD
+  static constexpr int BINS_PER_PERIOD = 32;      // Last bin also holds anything longer
+  using clock = std::chrono::steady_clock;
+
+  // ---- Audio thread ----
+
+  // Start of a callback; returns the start time (shared with later stages)
+  clock::time_point begin(uint64_t frames, double sampleRate) {
+    clock::time_point now = clock::now();
+    if (resetRequested.load(std::memory_order_acquire)) {
+      clearCounters();
+      resetRequested.store(false, std::memory_order_release);
+    }
+    periodSeconds = sampleRate > 0.0 ? frames / sampleRate : 0.0;
+    if (running && periodSeconds > 0.0 &&
+        std::chrono::duration<double>(now - callbackStart).count() > 1.5 * periodSeconds) {
+      bump(underruns);
+      TRACE_INSTANT("audio underrun");
+    }
+    running = true;
+    callbackStart = now;
+    stageStart = now;
+    return now;
+  }
+
+  // The stage that just finished
+  void mark(Stage stage) {
+    clock::time_point now = clock::now();
+    uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - stageStart).count();
+    stageNs[stage].store(stageNs[stage].load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    TRACE_COMPLETE(STAGE_NAMES[stage], stageStart, now);
+    stageStart = now;
+  }
+
+  // End of the callback: load, histogram, late count
+  void end() {
+    if (periodSeconds <= 0.0) return;
+    clock::time_point now = clock::now();
+    TRACE_COMPLETE("onSound", callbackStart, now);
+    double seconds = std::chrono::duration<double>(now - callbackStart).count();
+    float load = (float)(seconds / periodSeconds);
+    int bin = std::min((int)(load * BINS_PER_PERIOD), HISTOGRAM_BINS - 1);
+    bump(histogram[bin]);
+    bump(callbacks);
+    if (load > 1.0f) {
+      bump(late);
+      TRACE_INSTANT("late callback");
+    }
+    loadLast.store(load, std::memory_order_relaxed);
+    float smoothed = loadSmoothed.load(std::memory_order_relaxed);
+    loadSmoothed.store(smoothed + 0.05f * (load - smoothed), std::memory_order_relaxed);
+    if (load > loadMax.load(std::memory_order_relaxed)) loadMax.store(load, std::memory_order_relaxed);
+    periodMs.store((float)(periodSeconds * 1000.0), std::memory_order_relaxed);
+  }
+
+  // Calls end() on every return path of the callback
+  struct scope {
+    callback_timer& timer;
+    ~scope() { timer.end(); }
+  };
+
+  // ---- Any thread ----
+
+  uint64_t callbackCount() const { return callbacks.load(std::memory_order_relaxed); }
+  uint64_t lateCount() const { return late.load(std::memory_order_relaxed); }
+  uint64_t underrunCount() const { return underruns.load(std::memory_order_relaxed); }
+  float load() const { return loadSmoothed.load(std::memory_order_relaxed); }
+  float maxLoad() const { return loadMax.load(std::memory_order_relaxed); }
+  float headroom() const { return 1.0f - loadLast.load(std::memory_order_relaxed); }
+  float minHeadroom() const { return 1.0f - maxLoad(); }
+  float bufferPeriodMs() const { return periodMs.load(std::memory_order_relaxed); }
+  uint64_t histogramCount(int bin) const { return histogram[bin].load(std::memory_order_relaxed); }
+
+  // DSP load p of the callbacks stayed under (histogram bin resolution,
+  // 1/32 of a period; 2.0 = off the scale)
+  float loadPercentile(float p) const {
+    uint64_t total = callbackCount();
+    if (total == 0) return 0.0f;
+    uint64_t target = (uint64_t)std::ceil(p * total), seen = 0;
+    for (int b = 0; b < HISTOGRAM_BINS; b++) {
+      seen += histogramCount(b);
+      if (seen >= target) return (float)(b + 1) / BINS_PER_PERIOD;
+    }
+    return (float)HISTOGRAM_BINS / BINS_PER_PERIOD;
+  }
+
+  // Average ms per callback spent in a stage since the last reset
+  float stageMs(Stage stage) const {
+    uint64_t n = callbackCount();
+    return n > 0 ? (float)(stageNs[stage].load(std::memory_order_relaxed) * 1e-6 / n) : 0.0f;
+  }
+
+  void requestReset() { resetRequested.store(true, std::memory_order_release); }
+
+  // Summary as '#' comment lines, then one row per histogram bin
+  bool writeCsv(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+      std::cerr << "✗ ERROR: Could not write timing CSV: " << path << std::endl;
+      return false;
+    }
+    float period = bufferPeriodMs();
+    file << "# buffer_period_ms," << period << "\n";
+    file << "# callbacks," << callbackCount() << "\n";
+    file << "# late," << lateCount() << "\n";
+    file << "# underruns," << underrunCount() << "\n";
+    file << "# dsp_load_avg," << load() << "\n";
+    file << "# dsp_load_max," << maxLoad() << "\n";
+    for (int s = 0; s < NUM_STAGES; s++) {
+      file << "# stage_ms," << STAGE_NAMES[s] << "," << stageMs((Stage)s) << "\n";
+    }
+    file << "bin_start_ms,bin_end_ms,callbacks\n";
+    for (int b = 0; b < HISTOGRAM_BINS; b++) {
+      file << period * b / BINS_PER_PERIOD << "," << period * (b + 1) / BINS_PER_PERIOD << ","
+           << histogramCount(b) << "\n";
+    }
+    std::cout << "✓ Callback timing written to " << path << std::endl;
+    return true;
+  }
+
+private:
+  // Audio-thread state
+  clock::time_point callbackStart;
+  clock::time_point stageStart;
+  double periodSeconds = 0.0;
+  bool running = false;
+
+  // Single writer (audio thread), read anywhere
+  std::atomic<uint64_t> stageNs[NUM_STAGES] = {};
+  std::atomic<uint64_t> histogram[HISTOGRAM_BINS] = {};
+  std::atomic<uint64_t> callbacks{0};
+  std::atomic<uint64_t> late{0};
+  std::atomic<uint64_t> underruns{0};
+  std::atomic<float> loadSmoothed{0.0f};
+  std::atomic<float> loadMax{0.0f};
+  std::atomic<float> loadLast{0.0f};
+  std::atomic<float> periodMs{0.0f};
+  std::atomic<bool> resetRequested{false};
+
+  static void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void clearCounters() {
+    for (auto& s : stageNs) s.store(0, std::memory_order_relaxed);
+    for (auto& h : histogram) h.store(0, std::memory_order_relaxed);
+    callbacks.store(0, std::memory_order_relaxed);
+    late.store(0, std::memory_order_relaxed);
+    underruns.store(0, std::memory_order_relaxed);
+    loadMax.store(0.0f, std::memory_order_relaxed);
+    loadLast.store(0.0f, std::memory_order_relaxed);
+    running = false;
+  }
+};
+
+#endif // CALLBACK_TIMER_HPP
@@ -24,8 +24,17 @@
 
 namespace ChannelMapping {
 
-// Number of channel mappings (54 audio file channels -> 54 speakers)
-constexpr int NUM_CHANNELS = 56;
+// Number of channel mappings (54 speakers + sub). Must equal the number of
+// entries below: missing entries would silently become {0, 0}
+constexpr int NUM_CHANNELS = 55;
+
+// Subwoofer output (0-indexed Allo Ch 47 = output 48)
+constexpr int SUB_OUTPUT_CHANNEL = 47;
+
+// Speaker rings by 0-indexed Allo output (see layout above)
+enum class Ring { Upper, Middle, Lower, Sub, None };
+constexpr int NUM_RINGS = 4;  // Upper, Middle, Lower, Sub
+constexpr const char* RING_NAMES[NUM_RINGS] = {"Upper Ring", "Middle Ring", "Lower Ring", "Sub"};
 
 // ============================================================================
 // DEFAULT CHANNEL MAP (0-indexed) - Use for array/buffer indexing
@@ -214,6 +223,15 @@ inline int getInputChannel1Indexed(int allosphereChannel) {
     return -1; // Not mapped
 }
 
+// Ring of a 0-indexed Allo output (Ring::None for skipped outputs 12-15, 46)
+inline Ring getRing(int allosphereChannel) {
+    if (allosphereChannel >= 0 && allosphereChannel <= 11) return Ring::Upper;
+    if (allosphereChannel >= 16 && allosphereChannel <= 45) return Ring::Middle;
+    if (allosphereChannel >= 48 && allosphereChannel <= 59) return Ring::Lower;
+    if (allosphereChannel == SUB_OUTPUT_CHANNEL) return Ring::Sub;
+    return Ring::None;
+}
+
 // Convert 0-indexed to 1-indexed
 inline int toOneIndexed(int zeroIndexed) {
     return zeroIndexed + 1;
@@ -0,0 +1,200 @@
+/*
+  Local control socket (Unix domain, line protocol)
+
+  Lets scripts and a shell drive a headless player on the same machine:
+  every newline-terminated command gets one reply line. poll() is called
+  from the control loop (never the audio thread); it accepts clients,
+  reads whatever arrived and runs complete lines through the handler, so
+  commands execute on that one thread like GUI actions do.
+
+  The socket is only for its owner: defaultPath() is in $XDG_RUNTIME_DIR
+  (a per-user 0700 directory) when there is one, and the socket is made
+  0600 before it listens. open() replaces a stale socket from a previous
+  run but nothing else: a regular file, a link or a socket another player
+  still listens on are left alone and open() fails.
+
+  Try it with:  echo status | nc -U "$XDG_RUNTIME_DIR/adm-player.sock"
+*/
+
+#ifndef CONTROL_SOCKET_HPP
+#define CONTROL_SOCKET_HPP
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+struct control_socket {
+  static constexpr int MAX_CLIENTS = 8;
+  static constexpr size_t MAX_LINE = 1024;
+
+  ~control_socket() { close(); }
+
+  // $XDG_RUNTIME_DIR/adm-player.sock, else /tmp/adm-player-UID.sock
+  static std::string defaultPath() {
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir && runtimeDir[0] == '/') return std::string(runtimeDir) + "/adm-player.sock";
+    return "/tmp/adm-player-" + std::to_string(::getuid()) + ".sock";
+  }
+
+  bool open(const std::string& socketPath) {
+    close();
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+      std::cerr << "✗ ERROR: Control socket path too long: " << socketPath << std::endl;
+      return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+      std::cerr << "✗ ERROR: Could not create control socket: " << std::strerror(errno) << std::endl;
+      return false;
+    }
+    if (!removeStale(socketPath, address)) {
+      close();
+      return false;
+    }
+    // Owner only; nobody can connect before listen(), so there is no window
+    if (::bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || ::chmod(socketPath.c_str(), 0600) != 0 ||
+        ::listen(listenFd, MAX_CLIENTS) != 0) {
+      std::cerr << "✗ ERROR: Could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+      close();
+      return false;
+    }
+    setNonBlocking(listenFd);
+    path = socketPath;
+    std::cout << "✓ Control socket: " << path << std::endl;
+    return true;
+  }
+
+  void close() {
+    for (client& c : clients) ::close(c.fd);
+    clients.clear();
+    if (listenFd >= 0) {
+      ::close(listenFd);
+      if (isSocket(path)) ::unlink(path.c_str());
+    }
+    listenFd = -1;
+  }
+
+  bool isOpen() const { return listenFd >= 0; }
+
+  // Wait up to timeoutMs for activity, then reply to every complete line:
+  // handler(const std::string& command) -> std::string reply (no newline)
+  template <class Fn>
+  void poll(int timeoutMs, Fn&& handler) {
+    if (listenFd < 0) {
+      ::poll(nullptr, 0, timeoutMs);
+      return;
+    }
+    std::vector<pollfd> fds;
+    fds.push_back({listenFd, POLLIN, 0});
+    for (const client& c : clients) fds.push_back({c.fd, POLLIN, 0});
+    if (::poll(fds.data(), fds.size(), timeoutMs) <= 0) return;
+
+    // Existing clients first (accepting below changes the list)
+    for (size_t i = clients.size(); i-- > 0;) {
+      if (!(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+      if (!service(clients[i], handler)) {
+        ::close(clients[i].fd);
+        clients.erase(clients.begin() + i);
+      }
+    }
+    if (fds[0].revents & POLLIN) {
+      int fd = ::accept(listenFd, nullptr, nullptr);
+      if (fd >= 0) {
+        if ((int)clients.size() == MAX_CLIENTS) {
+          reply(fd, "error too many clients");
+          ::close(fd);
+        } else {
+          setNonBlocking(fd);
+          clients.push_back({fd, std::string()});
+        }
+      }
+    }
+  }
+
+private:
+  struct client {
+    int fd;
+    std::string pending;  // Bytes after the last newline
+  };
+
+  int listenFd = -1;
+  std::string path;
+  std::vector<client> clients;
+
+  static bool isSocket(const std::string& file) {
+    struct stat info;
+    return ::lstat(file.c_str(), &info) == 0 && S_ISSOCK(info.st_mode);
+  }
+
+  // Clear the path for bind(): nothing there, or a socket nobody listens on
+  // (left by a player that didn't shut down) which is removed
+  static bool removeStale(const std::string& socketPath, const sockaddr_un& address) {
+    struct stat info;
+    if (::lstat(socketPath.c_str(), &info) != 0) return errno == ENOENT;
+    if (!S_ISSOCK(info.st_mode)) {
+      std::cerr << "✗ ERROR: " << socketPath << " exists and is not a socket, not replacing it" << std::endl;
+      return false;
+    }
+    int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    bool live = probe >= 0 && ::connect(probe, (const sockaddr*)&address, sizeof(address)) == 0;
+    if (probe >= 0) ::close(probe);
+    if (live) {
+      std::cerr << "✗ ERROR: Another player is listening on " << socketPath << std::endl;
+      return false;
+    }
+    if (::unlink(socketPath.c_str()) != 0) {
+      std::cerr << "✗ ERROR: Could not remove stale socket " << socketPath << ": " << std::strerror(errno) << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  static void setNonBlocking(int fd) {
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  }
+
+  static void reply(int fd, std::string text) {
+    text += '\n';
+    ::send(fd, text.data(), text.size(), 0);
+  }
+
+  // Read what is available and run complete lines; false = client gone
+  template <class Fn>
+  bool service(client& c, Fn& handler) {
+    char chunk[512];
+    ssize_t n = ::recv(c.fd, chunk, sizeof(chunk), 0);
+    if (n == 0) return false;
+    if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+    c.pending.append(chunk, (size_t)n);
+
+    size_t newline;
+    while ((newline = c.pending.find('\n')) != std::string::npos) {
+      std::string line = c.pending.substr(0, newline);
+      c.pending.erase(0, newline + 1);
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.empty()) continue;
+      reply(c.fd, handler(line));
+    }
+    if (c.pending.size() > MAX_LINE) {
+      reply(c.fd, "error line too long");
+      return false;
+    }
+    return true;
+  }
+};
+
+#endif // CONTROL_SOCKET_HPP
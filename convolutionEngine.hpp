@@ -0,0 +1,474 @@
+/*
+  Partitioned FFT Convolution for per-speaker room correction
+
+  Each output channel can carry its own correction FIR (thousands of taps).
+  Filters are split into partitions of one audio block and convolved with
+  uniformly partitioned overlap-save: one forward FFT and one inverse FFT
+  per block, plus a complex multiply-accumulate over a frequency-domain
+  delay line (FDL). Latency is zero beyond the host block. The FFT is the
+  power of two at or above twice the block (fft.hpp is radix-2 only), so
+  any block size works; one that isn't a power of two pays for the
+  larger transform.
+
+  The 55 channel convolutions are spread over a small worker pool. Each
+  channel has its own job slot: the audio thread copies the channel into
+  the slot, hands out a ticket, wakes the workers and claims tickets
+  itself. Idle workers sleep on a semaphore (wakeSemaphore.hpp) that the
+  audio thread posts without blocking, only when a worker is asleep. It never waits past the deadline (a fraction of the buffer
+  period): a ticket nobody claimed by then is revoked, and a job a worker
+  is still running is left to finish in the background. Either way that
+  channel plays dry for the block (fading out the wet/dry difference so
+  nothing steps), is counted as a miss and is crossfaded back to wet once
+  its filter has caught up. A slot still busy from a late job is skipped
+  until the worker is done, so the audio thread never shares a buffer with
+  a worker. With realTime off (offline render) there is no deadline:
+  process() waits for every job, so no block is ever played dry.
+
+  A device block that is a whole number of partitions is convolved one
+  partition at a time. Any other block size passes through uncorrected and
+  is counted (blockMismatches); once the same size has come several times
+  in a row it is reported by mismatchedBlock() so the owner can load the
+  filters again partitioned for it.
+
+  Filter file: a multichannel WAV where channel N is the FIR for output N
+  (0-indexed Allo output). Silent channels are treated as "no filter".
+*/
+
+#ifndef CONVOLUTION_ENGINE_HPP
+#define CONVOLUTION_ENGINE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "al/io/al_AudioIOData.hpp"
+#include "Gamma/SoundFile.h"
+#include "fft.hpp"
+#include "traceRecorder.hpp"
+#include "wakeSemaphore.hpp"
+
+// Uniformly partitioned overlap-save convolver for a single channel
+struct partitioned_convolver {
+  int blockSize = 0;
+  int numPartitions = 0;
+
+  void init(const float* ir, int irLength, int block) {
+    blockSize = block;
+    numPartitions = (irLength + block - 1) / block;
+    windowSize = 2;
+    while (windowSize < 2 * block) windowSize *= 2;
+    fft.init(windowSize);
+    int bins = fft.bins();
+
+    filterRe.assign(numPartitions * bins, 0.0f);
+    filterIm.assign(numPartitions * bins, 0.0f);
+    fdlRe.assign(numPartitions * bins, 0.0f);
+    fdlIm.assign(numPartitions * bins, 0.0f);
+    accRe.assign(bins, 0.0f);
+    accIm.assign(bins, 0.0f);
+    inputHistory.assign(windowSize, 0.0f);
+    timeBuffer.assign(windowSize, 0.0f);
+
+    // Pre-transform every partition of the filter (zero-padded to the window)
+    for (int p = 0; p < numPartitions; p++) {
+      std::fill(timeBuffer.begin(), timeBuffer.end(), 0.0f);
+      int start = p * block;
+      int count = std::min(block, irLength - start);
+      std::copy(ir + start, ir + start + count, timeBuffer.begin());
+      fft.forward(timeBuffer.data(), &filterRe[p * bins], &filterIm[p * bins]);
+    }
+    fdlIndex = 0;
+  }
+
+  void reset() {
+    std::fill(fdlRe.begin(), fdlRe.end(), 0.0f);
+    std::fill(fdlIm.begin(), fdlIm.end(), 0.0f);
+    std::fill(inputHistory.begin(), inputHistory.end(), 0.0f);
+    fdlIndex = 0;
+  }
+
+  // Convolve one block in place (exactly blockSize samples)
+  void process(float* samples) {
+    int bins = fft.bins();
+
+    // Slide the input window: [older input | current block]
+    std::memmove(inputHistory.data(), inputHistory.data() + blockSize, (windowSize - blockSize) * sizeof(float));
+    std::memcpy(inputHistory.data() + windowSize - blockSize, samples, blockSize * sizeof(float));
+
+    // Newest input spectrum goes into the current FDL slot
+    fft.forward(inputHistory.data(), &fdlRe[fdlIndex * bins], &fdlIm[fdlIndex * bins]);
+
+    // Multiply-accumulate: sum over partitions of X[n - p] * H[p]
+    std::fill(accRe.begin(), accRe.end(), 0.0f);
+    std::fill(accIm.begin(), accIm.end(), 0.0f);
+    for (int p = 0; p < numPartitions; p++) {
+      int slot = fdlIndex - p;
+      if (slot < 0) slot += numPartitions;
+      const float* __restrict xr = &fdlRe[slot * bins];
+      const float* __restrict xi = &fdlIm[slot * bins];
+      const float* __restrict hr = &filterRe[p * bins];
+      const float* __restrict hi = &filterIm[p * bins];
+      float* __restrict ar = accRe.data();
+      float* __restrict ai = accIm.data();
+      for (int k = 0; k < bins; k++) {
+        ar[k] += xr[k] * hr[k] - xi[k] * hi[k];
+        ai[k] += xr[k] * hi[k] + xi[k] * hr[k];
+      }
+    }
+
+    // Back to time domain; the last block is valid (non-aliased): it is
+    // at least one partition past the start of the window
+    fft.inverse(accRe.data(), accIm.data(), timeBuffer.data());
+    std::memcpy(samples, timeBuffer.data() + windowSize - blockSize, blockSize * sizeof(float));
+
+    fdlIndex = (fdlIndex + 1) % numPartitions;
+  }
+
+private:
+  fft_plan fft;
+  std::vector<float> filterRe, filterIm;  // numPartitions x bins
+  std::vector<float> fdlRe, fdlIm;        // numPartitions x bins (ring)
+  std::vector<float> accRe, accIm;
+  std::vector<float> inputHistory;        // windowSize
+  std::vector<float> timeBuffer;          // windowSize
+  int windowSize = 0;                     // FFT size: power of two >= 2 * blockSize
+  int fdlIndex = 0;
+};
+
+// Multichannel convolution stage with a deadline-aware worker pool
+struct convolution_engine {
+  std::atomic<bool> enabled{true};  // Written by the GUI, read by the audio thread
+  float deadlineFraction = 0.75f;  // Share of the buffer period convolution may use
+  bool realTime = true;            // false: no deadline, wait for every job (set with audio stopped)
+  int fadeFrames = 64;             // Length of the wet -> dry fade on a miss
+
+  // Stats published for the GUI (written by the audio thread only; the
+  // callback's headroom is measured by callback_timer at its end)
+  std::atomic<float> stageLoad{0.0f};     // Convolution time / buffer period
+  std::atomic<uint64_t> deadlineMisses{0};  // Channel blocks played dry
+  std::atomic<uint64_t> blockMismatches{0}; // Device blocks passed through (not a multiple of the partition)
+
+  ~convolution_engine() { stopWorkers(); }
+
+  // Load a multichannel FIR file and prepare one convolver per non-silent channel.
+  // Must be called before audio starts (allocates and spawns threads).
+  bool load(const std::string& path, int outputChannels, int block, double sampleRate) {
+    stopWorkers();
+    convolvers.clear();
+    jobs.clear();
+    mismatchRun = 0;
+    mismatchFrames.store(0);
+
+    gam::SoundFile firFile;
+    if (!firFile.openRead(path)) {
+      std::cerr << "✗ ERROR: Could not open correction filter file: " << path << std::endl;
+      return false;
+    }
+    if (firFile.frameRate() != sampleRate) {
+      std::cerr << "⚠ WARNING: Correction filters are " << firFile.frameRate()
+                << " Hz but playback runs at " << sampleRate << " Hz" << std::endl;
+    }
+
+    int firChannels = firFile.channels();
+    int taps = firFile.frames();
+    std::vector<float> interleaved((size_t)taps * firChannels);
+    firFile.read(interleaved.data(), taps);
+    firFile.close();
+
+    blockSize = block;
+    convolvers.resize(outputChannels);
+    slots.reset(new channel_slot[outputChannels]);
+    std::vector<float> ir(taps);
+    for (int ch = 0; ch < std::min(firChannels, outputChannels); ch++) {
+      // Trim trailing silence so short filters don't pay for the longest one
+      int length = 0;
+      for (int i = 0; i < taps; i++) {
+        ir[i] = interleaved[(size_t)i * firChannels + ch];
+        if (ir[i] != 0.0f) length = i + 1;
+      }
+      if (length == 0) continue;
+      convolvers[ch].init(ir.data(), length, block);
+      slots[ch].wet.assign(block, 0.0f);
+      jobs.push_back(ch);
+    }
+
+    // Longest filters first so the expensive jobs start earliest
+    std::sort(jobs.begin(), jobs.end(), [this](int a, int b) {
+      return convolvers[a].numPartitions > convolvers[b].numPartitions;
+    });
+
+    std::cout << "✓ Correction filters loaded: " << jobs.size() << " channels, "
+              << taps << " taps, " << block << "-frame partitions" << std::endl;
+
+    startWorkers();
+    return !jobs.empty();
+  }
+
+  bool ready() const { return !jobs.empty(); }
+  int activeChannels() const { return static_cast<int>(jobs.size()); }
+  int workerCount() const { return static_cast<int>(workers.size()); }
+  int partitionFrames() const { return blockSize; }
+
+  // Device block size that keeps being passed through uncorrected (0 = none):
+  // load() again with it as the partition size
+  int mismatchedBlock() const { return mismatchFrames.load(std::memory_order_relaxed); }
+
+  // Frames the longest filter rings on after its input stops
+  int tailFrames() const {
+    int partitions = 0;
+    for (int ch : jobs) partitions = std::max(partitions, convolvers[ch].numPartitions);
+    return partitions * blockSize;
+  }
+
+  // Convolve the output buffers in place, one partition at a time.
+  // callbackStart is the time the audio callback began, used for the
+  // deadline. Returns false if the block was left untouched (disabled, not
+  // loaded, or a block size the partitions don't divide).
+  bool process(al::AudioIOData& io, std::chrono::steady_clock::time_point callbackStart) {
+    using clock = std::chrono::steady_clock;
+    int frames = (int)io.framesPerBuffer();
+    if (jobs.empty() || frames <= 0) return false;
+    int outputs = io.channelsOut();
+    if (frames % blockSize != 0) return passThrough(io, outputs, frames);
+    if (mismatchRun > 0) {
+      mismatchRun = 0;  // Back to a size the partitions fit
+      mismatchFrames.store(0, std::memory_order_relaxed);
+    }
+    if (!enabled.load(std::memory_order_relaxed)) return fadeToDry(io, outputs, frames);
+
+    double period = (double)frames / io.framesPerSecond();
+    clock::time_point deadline = clock::time_point::max();
+    if (realTime) {
+      deadline = callbackStart + std::chrono::duration_cast<clock::duration>(
+                                     std::chrono::duration<double>(period * deadlineFraction));
+    }
+    deadlineTicks.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+    clock::time_point stageStart = clock::now();
+
+    uint64_t misses = 0;
+    for (int first = 0; first < frames; first += blockSize) {
+      misses += processPartition(io, outputs, first, deadline);
+    }
+    if (misses > 0) deadlineMisses.fetch_add(misses, std::memory_order_relaxed);
+
+    float load = (float)(std::chrono::duration<double>(clock::now() - stageStart).count() / period);
+    stageLoad.store(load, std::memory_order_relaxed);
+    return true;
+  }
+
+  void resetStats() {
+    deadlineMisses.store(0);
+    blockMismatches.store(0);
+  }
+
+private:
+  // One output channel's job. ticket and done carry (block << 1) plus a flag
+  // in bit 0: "reset the filter first" on the ticket, "skipped" on done.
+  struct channel_slot {
+    std::atomic<uint32_t> ticket{0};  // 0 = nothing to claim
+    std::atomic<uint32_t> done{0};    // Last block finished (or skipped)
+    std::vector<float> wet;           // Owned by whoever holds the ticket
+
+    // Audio thread only
+    uint32_t queued = 0;  // Last block handed out
+    bool needsReset = false;
+    bool wasWet = true;   // Filters start in step with the signal
+    float lastOut = 0.0f;  // Last sample played / its dry value, for the fade
+    float lastDry = 0.0f;
+  };
+
+  int blockSize = 0;
+  uint32_t block = 0;  // Audio thread's block counter (31 bits, never 0)
+  std::vector<partitioned_convolver> convolvers;  // Indexed by output channel
+  std::unique_ptr<channel_slot[]> slots;          // Indexed by output channel
+  std::vector<int> jobs;                          // Output channels with a filter, longest first
+  std::atomic<int64_t> deadlineTicks{0};          // steady_clock ticks
+  int mismatchRun = 0;                            // Audio thread: same odd block size in a row
+  int lastMismatch = 0;
+  std::atomic<int> mismatchFrames{0};             // Reported odd block size (0 = none)
+  static constexpr int MISMATCH_REPORT = 8;       // Blocks in a row before it is reported
+
+  std::vector<std::thread> workers;
+  wake_semaphore wake;
+  std::atomic<uint32_t> generation{0};  // Bumped per partition handed out
+  std::atomic<int> sleepers{0};         // Workers about to wait / waiting on wake
+  std::atomic<bool> quit{false};
+
+  // One partition of every channel, at frame `first` of the outputs.
+  // Returns the channels played dry.
+  uint64_t processPartition(al::AudioIOData& io, int outputs, int first,
+                            std::chrono::steady_clock::time_point deadline) {
+    using clock = std::chrono::steady_clock;
+
+    // Hand out one ticket per idle channel (bit 0 asks for a filter reset)
+    block = (block + 1) & 0x7fffffffu;
+    if (block == 0) block = 1;
+    for (int ch : jobs) {
+      if (ch >= outputs) continue;
+      channel_slot& slot = slots[ch];
+      if ((slot.done.load(std::memory_order_acquire) >> 1) != slot.queued) {
+        slot.needsReset = true;  // A late job still owns the slot
+        continue;
+      }
+      std::memcpy(slot.wet.data(), io.outBuffer(ch) + first, blockSize * sizeof(float));
+      slot.queued = block;
+      slot.ticket.store(block << 1 | (slot.needsReset ? 1u : 0u), std::memory_order_release);
+      slot.needsReset = false;
+    }
+    // seq_cst pairs with the worker's sleepers / generation check: either
+    // this sees the sleeper or the worker sees the new generation
+    generation.fetch_add(1);
+    int asleep = sleepers.load();
+    if (asleep > 0) wake.post(asleep);
+
+    // Help out, then wait for the workers but never past the deadline
+    runJobs();
+    while (pendingJobs() && clock::now() < deadline) std::this_thread::yield();
+
+    uint64_t misses = 0;
+    for (int ch : jobs) {
+      if (ch >= outputs) continue;
+      channel_slot& slot = slots[ch];
+      float* out = io.outBuffer(ch) + first;
+      float dryLast = out[blockSize - 1];
+      bool queued = slot.queued == block;
+      if (queued) {
+        // Revoke a ticket nobody claimed; a claimed job finishes on its own
+        uint32_t ticket = slot.ticket.load(std::memory_order_relaxed);
+        if (ticket != 0 && slot.ticket.compare_exchange_strong(ticket, 0, std::memory_order_acq_rel)) {
+          slot.done.store(block << 1 | 1u, std::memory_order_release);
+        }
+      }
+      uint32_t done = slot.done.load(std::memory_order_acquire);
+      if (queued && done == block << 1) {
+        if (slot.wasWet) {
+          std::memcpy(out, slot.wet.data(), blockSize * sizeof(float));
+        } else {
+          // Back from dry: crossfade over the partition
+          float step = 1.0f / blockSize;
+          for (int i = 0; i < blockSize; i++) {
+            out[i] += (slot.wet[i] - out[i]) * (float)(i + 1) * step;
+          }
+        }
+        slot.wasWet = true;
+      } else {
+        // Skipped or revoked jobs left a gap in the filter history
+        if (queued && done == (block << 1 | 1u)) slot.needsReset = true;
+        fadeOut(slot, out, blockSize);
+        misses++;
+      }
+      slot.lastOut = out[blockSize - 1];
+      slot.lastDry = dryLast;
+    }
+    return misses;
+  }
+
+  // A block the partitions don't divide: fade to dry, count it, and report
+  // the size once it keeps coming
+  bool passThrough(al::AudioIOData& io, int outputs, int frames) {
+    blockMismatches.fetch_add(1, std::memory_order_relaxed);
+    mismatchRun = frames == lastMismatch ? mismatchRun + 1 : 1;
+    lastMismatch = frames;
+    if (mismatchRun == MISMATCH_REPORT) mismatchFrames.store(frames, std::memory_order_relaxed);
+    return fadeToDry(io, outputs, frames);
+  }
+
+  // Claim every open ticket (audio thread and workers)
+  void runJobs() {
+    using clock = std::chrono::steady_clock;
+    for (int ch : jobs) {
+      channel_slot& slot = slots[ch];
+      uint32_t ticket = slot.ticket.load(std::memory_order_relaxed);
+      if (ticket == 0 || !slot.ticket.compare_exchange_strong(ticket, 0, std::memory_order_acq_rel)) {
+        continue;
+      }
+      if (ticket & 1u) convolvers[ch].reset();
+      clock::time_point deadline{clock::duration(deadlineTicks.load(std::memory_order_relaxed))};
+      if (clock::now() < deadline) {
+        convolvers[ch].process(slot.wet.data());
+        slot.done.store(ticket & ~1u, std::memory_order_release);
+      } else {
+        slot.done.store(ticket | 1u, std::memory_order_release);
+      }
+    }
+  }
+
+  bool pendingJobs() const {
+    for (int ch : jobs) {
+      const channel_slot& slot = slots[ch];
+      if (slot.queued == block && (slot.done.load(std::memory_order_acquire) >> 1) != block) return true;
+    }
+    return false;
+  }
+
+  // Play the dry signal (`available` frames of it), fading out the wet/dry
+  // difference of the previous block so the switch doesn't step
+  void fadeOut(channel_slot& slot, float* out, int available) {
+    if (!slot.wasWet) return;
+    int frames = std::min(fadeFrames, available);
+    float offset = slot.lastOut - slot.lastDry;
+    for (int i = 0; i < frames; i++) {
+      out[i] += offset * (float)(frames - 1 - i) / frames;
+    }
+    slot.wasWet = false;
+  }
+
+  // Bypassed (GUI or block size): fade any wet channel to dry once, then
+  // leave the block untouched. The filters restart from silence after.
+  bool fadeToDry(al::AudioIOData& io, int outputs, int frames) {
+    bool faded = false;
+    for (int ch : jobs) {
+      channel_slot& slot = slots[ch];
+      if (!slot.wasWet || ch >= outputs) continue;
+      fadeOut(slot, io.outBuffer(ch), frames);
+      slot.needsReset = true;
+      faded = true;
+    }
+    return faded;
+  }
+
+  void workerLoop() {
+    TRACE_THREAD("convolution worker");
+    uint32_t seen = generation.load();
+    while (!quit.load()) {
+      uint32_t current = generation.load(std::memory_order_acquire);
+      if (current == seen) {
+        // Announce the sleep, then look again before waiting. A post meant
+        // for a worker that didn't sleep after all leaves a spare count:
+        // one extra pass round this loop later, nothing more.
+        sleepers.fetch_add(1);
+        if (generation.load() == seen && !quit.load()) wake.wait();
+        sleepers.fetch_sub(1);
+        continue;
+      }
+      seen = current;
+      TRACE_SCOPE("convolution jobs");
+      runJobs();
+    }
+  }
+
+  void startWorkers() {
+    int hw = static_cast<int>(std::thread::hardware_concurrency());
+    int count = std::min(std::max(hw - 1, 0), 8);
+    count = std::min(count, static_cast<int>(jobs.size()) - 1);
+    quit.store(false);
+    for (int i = 0; i < count; i++) {
+      workers.emplace_back([this] { workerLoop(); });
+    }
+    std::cout << "  Convolution worker threads: " << workers.size() << std::endl;
+  }
+
+  void stopWorkers() {
+    quit.store(true);
+    wake.post(static_cast<int>(workers.size()));
+    for (auto& t : workers) t.join();
+    workers.clear();
+  }
+};
+
+#endif // CONVOLUTION_ENGINE_HPP
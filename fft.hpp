@@ -0,0 +1,144 @@
+/*
+  Real FFT for block-based DSP (convolution, analysis)
+
+  Power-of-two real-to-complex transform built on a half-size complex
+  radix-2 FFT. Spectra are stored split (separate real / imaginary arrays
+  of n/2 + 1 bins) so per-bin loops over several spectra vectorize.
+
+  All tables and scratch are allocated in init(); forward() and inverse()
+  never allocate and are safe to call from the audio thread. A plan is not
+  thread-safe: give every thread (or every channel) its own plan.
+*/
+
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <cmath>
+#include <vector>
+
+struct fft_plan {
+  int size = 0;   // Real transform size (power of two)
+  int half = 0;   // size / 2 = complex FFT size, bins = half + 1
+
+  void init(int n) {
+    size = n;
+    half = n / 2;
+
+    // Bit-reversal permutation for the half-size complex FFT
+    bitrev.assign(half, 0);
+    int bits = 0;
+    while ((1 << bits) < half) bits++;
+    for (int i = 0; i < half; i++) {
+      int r = 0;
+      for (int b = 0; b < bits; b++) {
+        if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+      }
+      bitrev[i] = r;
+    }
+
+    // Twiddles for the complex FFT: exp(-2*pi*i*k / half)
+    twRe.resize(half / 2 + 1);
+    twIm.resize(half / 2 + 1);
+    for (int k = 0; k <= half / 2; k++) {
+      double a = -2.0 * M_PI * k / half;
+      twRe[k] = (float)cos(a);
+      twIm[k] = (float)sin(a);
+    }
+
+    // Real-input post-processing twiddles: exp(-2*pi*i*k / size)
+    postRe.resize(half + 1);
+    postIm.resize(half + 1);
+    for (int k = 0; k <= half; k++) {
+      double a = -2.0 * M_PI * k / size;
+      postRe[k] = (float)cos(a);
+      postIm[k] = (float)sin(a);
+    }
+
+    workRe.assign(half, 0.0f);
+    workIm.assign(half, 0.0f);
+  }
+
+  int bins() const { return half + 1; }
+
+  // in: size real samples -> re/im: half + 1 bins (unnormalized)
+  void forward(const float* in, float* re, float* im) {
+    // Pack even/odd samples as a half-size complex sequence
+    for (int i = 0; i < half; i++) {
+      int j = bitrev[i];
+      workRe[j] = in[2 * i];
+      workIm[j] = in[2 * i + 1];
+    }
+    complexTransform(false);
+
+    // Untangle the even/odd spectra
+    re[0] = workRe[0] + workIm[0];
+    im[0] = 0.0f;
+    re[half] = workRe[0] - workIm[0];
+    im[half] = 0.0f;
+    for (int k = 1; k < half; k++) {
+      float zr = workRe[k], zi = workIm[k];
+      float cr = workRe[half - k], ci = -workIm[half - k];  // conj(Z[M-k])
+      float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+      float dr = 0.5f * (zr - cr), di = 0.5f * (zi - ci);
+      // odd = -i * d
+      float orr = di, oi = -dr;
+      re[k] = er + postRe[k] * orr - postIm[k] * oi;
+      im[k] = ei + postRe[k] * oi + postIm[k] * orr;
+    }
+  }
+
+  // re/im: half + 1 bins -> out: size real samples (scaled by 1/size)
+  void inverse(const float* re, const float* im, float* out) {
+    for (int k = 0; k < half; k++) {
+      float xr = re[k], xi = im[k];
+      float cr = re[half - k], ci = -im[half - k];  // conj(X[M-k])
+      float er = 0.5f * (xr + cr), ei = 0.5f * (xi + ci);
+      float wr = 0.5f * (xr - cr), wi = 0.5f * (xi - ci);
+      // odd = conj(W^k) * w
+      float orr = postRe[k] * wr + postIm[k] * wi;
+      float oi = postRe[k] * wi - postIm[k] * wr;
+      // Z = even + i * odd, stored bit-reversed for the transform
+      int j = bitrev[k];
+      workRe[j] = er - oi;
+      workIm[j] = ei + orr;
+    }
+    complexTransform(true);
+
+    float scale = 1.0f / half;
+    for (int i = 0; i < half; i++) {
+      out[2 * i] = workRe[i] * scale;
+      out[2 * i + 1] = workIm[i] * scale;
+    }
+  }
+
+private:
+  std::vector<int> bitrev;
+  std::vector<float> twRe, twIm;
+  std::vector<float> postRe, postIm;
+  std::vector<float> workRe, workIm;
+
+  // In-place iterative radix-2 DIT on bit-reversed work arrays
+  void complexTransform(bool inverseDir) {
+    float sign = inverseDir ? -1.0f : 1.0f;
+    for (int len = 2; len <= half; len <<= 1) {
+      int step = half / len;
+      int hl = len / 2;
+      for (int start = 0; start < half; start += len) {
+        for (int k = 0; k < hl; k++) {
+          int t = k * step;
+          float wr = twRe[t];
+          float wi = twIm[t] * sign;
+          int a = start + k, b = a + hl;
+          float br = workRe[b] * wr - workIm[b] * wi;
+          float bi = workRe[b] * wi + workIm[b] * wr;
+          workRe[b] = workRe[a] - br;
+          workIm[b] = workIm[a] - bi;
+          workRe[a] += br;
+          workIm[a] += bi;
+        }
+      }
+    }
+  }
+};
+
+#endif // FFT_HPP
@@ -0,0 +1,127 @@
+/*
+  Adaptive GUI refresh
+
+  The GUI shares the machine with the audio callback, so it only redraws
+  as often as the situation needs:
+  - ACTIVE:   recent mouse / keyboard input          -> activeFps
+  - METERING: playing (or meters still falling), no
+              input for idleSeconds                  -> meterFps
+  - IDLE:     stopped, meters settled, a few frames
+              still to draw after the last change    -> idleFps
+  - SLEEP:    stopped and nothing dirty              -> the GUI is not
+              rebuilt, the last frame is only repainted (the app swaps
+              buffers after every onDraw); the loop keeps running at
+              idleFps only to notice input
+
+  beginFrame() runs at the top of onDraw, decides the mode and says whether
+  to build a new frame; the app applies targetFps() to its frame rate.
+  Window events call wake(); state changes outside the GUI (file loads,
+  transport and rate changes, end of file) call markDirty() from any
+  thread, the audio thread included.
+
+  GUI-thread CPU time (thread CPU clock, between successive frames, so the
+  frame loop's own cost is included) is reported per mode as a share of
+  one core.
+*/
+
+#ifndef GUI_THROTTLE_HPP
+#define GUI_THROTTLE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+
+struct gui_throttle {
+  enum Mode { ACTIVE, METERING, IDLE, SLEEP, NUM_MODES };
+  static constexpr const char* MODE_NAMES[NUM_MODES] = {"Active", "Metering", "Idle", "Sleep"};
+
+  bool enabled = true;       // Off = always ACTIVE at activeFps
+  float activeFps = 60.0f;
+  float meterFps = 20.0f;    // Meter refresh while playing hands-off
+  float idleFps = 5.0f;      // Also the input polling rate while asleep
+  float idleSeconds = 2.0f;  // No input for this long leaves ACTIVE
+  int settleFrames = 3;      // Frames drawn after the last change before sleeping
+
+  // Window input: back to ACTIVE
+  void wake() {
+    lastInput = clock::now();
+    dirtyFrames = settleFrames;
+  }
+
+  // Something visible changed without input (any thread, lock-free)
+  void markDirty() { dirty.store(true, std::memory_order_release); }
+
+  // Top of onDraw. animating: something on screen still moves on its own
+  // (meters falling, analysis running). Returns false to repaint the last
+  // frame instead of building a new one.
+  bool beginFrame(bool playing, bool animating) {
+    clock::time_point now = clock::now();
+    double cpuNow = threadCpuSeconds();
+    if (started) account(now, cpuNow);
+    started = true;
+    lastFrame = now;
+    lastCpu = cpuNow;
+
+    if (dirty.exchange(false, std::memory_order_acquire)) dirtyFrames = settleFrames;
+    double sinceInput = std::chrono::duration<double>(now - lastInput).count();
+    if (!enabled || sinceInput < idleSeconds) {
+      current = ACTIVE;
+    } else if (playing || animating) {
+      current = METERING;
+    } else if (dirtyFrames > 0) {
+      current = IDLE;
+    } else {
+      current = SLEEP;
+    }
+    if (current != SLEEP && dirtyFrames > 0) dirtyFrames--;
+    if (playing || animating) dirtyFrames = settleFrames;  // Settle again once they stop
+    return current != SLEEP;
+  }
+
+  Mode mode() const { return current; }
+
+  double targetFps() const {
+    switch (current) {
+      case ACTIVE: return activeFps;
+      case METERING: return meterFps;
+      default: return idleFps;
+    }
+  }
+
+  // GUI-thread CPU while in a mode, share of one core (last full second in it)
+  float cpuLoad(Mode m) const { return load[m]; }
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  Mode current = ACTIVE;
+  clock::time_point lastInput = clock::now();
+  clock::time_point lastFrame;
+  double lastCpu = 0.0;
+  bool started = false;
+  int dirtyFrames = 3;
+  std::atomic<bool> dirty{false};
+
+  double cpuSeconds[NUM_MODES] = {};
+  double wallSeconds[NUM_MODES] = {};
+  float load[NUM_MODES] = {};
+
+  static double threadCpuSeconds() {
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0.0;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+  }
+
+  // The interval since the last frame belongs to the mode chosen then
+  void account(clock::time_point now, double cpuNow) {
+    cpuSeconds[current] += cpuNow - lastCpu;
+    wallSeconds[current] += std::chrono::duration<double>(now - lastFrame).count();
+    if (wallSeconds[current] >= 1.0) {
+      load[current] = (float)(cpuSeconds[current] / wallSeconds[current]);
+      cpuSeconds[current] = 0.0;
+      wallSeconds[current] = 0.0;
+    }
+  }
+};
+
+#endif // GUI_THROTTLE_HPP
@@ -0,0 +1,294 @@
+/*
+Headless 54-Channel Audio Player
+Runs the player core on the audio backend alone: no window, no GL context, no
+graphics loop. Configured from a config file and / or the command line and
+driven at runtime through a local control socket. With --render it plays
+the file once through the same chain into a 60-channel WAV / BW64 file
+instead, faster than real time and without an audio device.
+
+  ./headlessplayer --config player.conf --play
+  echo "load 2" | nc -U "$XDG_RUNTIME_DIR/adm-player.sock"
+  ./headlessplayer --file mix.wav --gain 1 --render speakers.wav
+  ./headlessplayer --verify-routing   # Bit-exact routing self-check, exit 1 on failure
+
+Config file: one `key = value` per line, `#` starts a comment. Command-line
+options use the same keys (`--folder ../sourceAudio/`) and override the file
+(playerConfig.hpp, which also lists the audio device keys).
+*/
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include "controlSocket.hpp"
+#include "offlineRender.hpp"
+#include "playerConfig.hpp"
+#include "playerCore.hpp"
+#include "routingVerify.hpp"
+
+static std::atomic<bool> quitRequested{false};
+
+static void onSignal(int) { quitRequested.store(true); }
+
+static void playerAudioCallback(AudioIOData& io) { io.user<player_core>().onSound(io); }
+
+static void printUsage() {
+  std::cout << "Usage: headlessplayer [--config FILE] [--KEY VALUE ...] | --verify-routing\n"
+            << "Keys (config file or command line):\n"
+            << "  folder      Audio folder, relative to the working directory\n"
+            << "  file        File to open at startup (default: first in folder)\n"
+            << "  correction  Room-correction FIR WAV (multichannel)\n"
+            << "  socket      Control socket path (default $XDG_RUNTIME_DIR/adm-player.sock, else\n"
+            << "              /tmp/adm-player-UID.sock; 'off' = none)\n"
+            << "  gain        Master gain 0-1\n"
+            << "  loop        on / off\n"
+            << "  play        on / off: start playing after startup (--play = on)\n"
+            << "  samplerate  Device sample rate in Hz (default 48000)\n"
+            << "  blocksize   Device buffer size in frames (default 512)\n"
+            << "  outputs     Output channels (default 60)\n"
+            << "  inputs      Input channels (default 0)\n"
+            << "  matchrate   on / off: reopen the device at each file's sample rate (default on)\n"
+            << "  live        on / off: route the inputs instead of the file\n"
+            << "  render      Output file: render the file offline to it and exit\n"
+            << "  format      Render / recording sample format: float (default) / pcm24\n"
+            << "  prealloc    Disk space reserved per recording, in minutes (default 0)\n"
+            << "Control commands: play, pause, stop, rewind, seek SECONDS, loop on|off,\n"
+            << "  gain VALUE, list, load INDEX|NAME, status, timing [reset | csv PATH],\n"
+            << "  stream [reset], trace start|stop|write PATH, live on|off,\n"
+            << "  record [start [PATH] | inputs [PATH] | stop], quit" << std::endl;
+}
+
+// Config file + command line ("--help" / bad arguments print the usage)
+static bool parseArgs(int argc, char* argv[], player_config& config) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      printUsage();
+      return false;
+    }
+  }
+  if (!config.parse(argc, argv, {"play", "verify-routing"})) {
+    printUsage();
+    return false;
+  }
+  return true;
+}
+
+// One control command -> one reply line
+static std::string runCommand(player_core& player, const std::string& line) {
+  std::istringstream words(line);
+  std::string command, argument;
+  words >> command;
+  std::getline(words, argument);
+  argument = trim(argument);
+
+  if (command == "play") {
+    if (!player.soundFile.opened()) return "error no file loaded";
+    player.playing = true;
+  } else if (command == "pause") {
+    player.playing = false;
+  } else if (command == "stop") {
+    player.playing = false;
+    player.frameCounter = 0;
+  } else if (command == "rewind") {
+    player.frameCounter = 0;
+  } else if (command == "seek") {
+    double seconds = std::atof(argument.c_str());
+    uint64_t frame = (uint64_t)std::max(0.0, seconds * player.soundFile.frameRate());
+    if (frame >= (uint64_t)player.soundFile.frames()) return "error past end of file";
+    player.frameCounter = frame;
+  } else if (command == "loop") {
+    player.loop = argument.empty() ? !player.loop : isTrue(argument);
+  } else if (command == "live") {
+    bool on = argument.empty() ? !player.liveInput.load() : isTrue(argument);
+    if (on && player.inputChannels == 0) return "error no inputs open (start with --inputs N)";
+    player.liveInput.store(on);
+  } else if (command == "gain") {
+    player.gain = std::min(std::max((float)std::atof(argument.c_str()), 0.0f), 1.0f);
+  } else if (command == "list") {
+    std::string reply = "ok";
+    for (size_t i = 0; i < player.audioFiles.size(); i++) {
+      reply += " " + std::to_string(i + 1) + ":" + player.audioFiles[i];
+    }
+    return reply;
+  } else if (command == "load") {
+    int index = -1;
+    for (size_t i = 0; i < player.audioFiles.size(); i++) {
+      if (player.audioFiles[i] == argument) index = (int)i;
+    }
+    if (index < 0 && !argument.empty() && argument.find_first_not_of("0123456789") == std::string::npos) {
+      index = std::atoi(argument.c_str()) - 1;  // 1-indexed, like the number keys
+    }
+    if (index < 0 || index >= (int)player.audioFiles.size()) return "error no such file: " + argument;
+    if (!player.loadAudioFile(player.audioFiles[index])) return "error could not open " + argument;
+    player.selectedFileIndex = index;
+  } else if (command == "status") {
+    char reply[512];
+    double rate = player.soundFile.frameRate() > 0 ? player.soundFile.frameRate() : 1.0;
+    std::snprintf(reply, sizeof(reply), "ok %s file=%s time=%.2f/%.2f loop=%s gain=%.3f live=%s",
+                  player.playing ? "playing" : "stopped",
+                  player.audioFiles.empty() ? "-" : player.audioFiles[player.selectedFileIndex].c_str(),
+                  player.frameCounter / rate, player.soundFile.frames() / rate, player.loop ? "on" : "off",
+                  player.gain, player.liveInput.load() ? "on" : "off");
+    return reply;
+  } else if (command == "timing") {
+    if (argument.compare(0, 4, "csv ") == 0) {
+      return player.callbackTiming.writeCsv(trim(argument.substr(4))) ? "ok" : "error could not write CSV";
+    }
+    if (argument == "reset") {
+      player.callbackTiming.requestReset();
+      return "ok";
+    }
+    char reply[256];
+    std::snprintf(reply, sizeof(reply),
+                  "ok load=%.3f max=%.3f p999=%.3f callbacks=%llu late=%llu underruns=%llu rate=%.0f block=%d",
+                  player.callbackTiming.load(), player.callbackTiming.maxLoad(),
+                  player.callbackTiming.loadPercentile(0.999f),
+                  (unsigned long long)player.callbackTiming.callbackCount(),
+                  (unsigned long long)player.callbackTiming.lateCount(),
+                  (unsigned long long)player.callbackTiming.underrunCount(), player.audioSampleRate,
+                  player.audioBlockSize);
+    return reply;
+  } else if (command == "stream") {
+    if (argument == "reset") {
+      player.stream.requestReset();
+      return "ok";
+    }
+    char reply[256];
+    std::snprintf(reply, sizeof(reply),
+                  "ok fill=%.0f min=%.0f prefetch=%.0f read_p50=%.2f read_p99=%.2f read_max=%.2f "
+                  "mbps=%.1f needed=%.1f near_underruns=%llu underruns=%llu",
+                  player.stream.fillMs(), player.stream.minFillMs(), player.stream.prefetchMs(),
+                  player.stream.readPercentileMs(0.5f), player.stream.readPercentileMs(0.99f),
+                  player.stream.maxReadMs(), player.stream.readMBps(), player.stream.requiredMBps(),
+                  (unsigned long long)player.stream.nearUnderrunCount(),
+                  (unsigned long long)player.stream.underrunCount());
+    return reply;
+  } else if (command == "trace") {
+    if (!trace_recorder::compiledIn) return "error tracing not compiled in (ADM_TRACE=OFF)";
+    if (argument == "start") {
+      tracer().start();
+    } else if (argument == "stop") {
+      tracer().stop();
+    } else if (argument.compare(0, 6, "write ") == 0) {
+      return tracer().writeJson(trim(argument.substr(6))) ? "ok" : "error could not write trace";
+    } else {
+      return std::string("ok ") + (tracer().active() ? "recording" : "stopped");
+    }
+  } else if (command == "record") {
+    bool inputs = argument.compare(0, 6, "inputs") == 0;
+    if (inputs || argument.compare(0, 5, "start") == 0) {
+      std::string path = trim(argument.substr(inputs ? 6 : 5));
+      if (path.empty()) {
+        char name[64];
+        std::time_t now = std::time(nullptr);
+        std::strftime(name, sizeof(name), "recording_%Y%m%d_%H%M%S.wav", std::localtime(&now));
+        path = name;
+      }
+      auto source = inputs ? block_recorder::INPUTS : block_recorder::OUTPUTS;
+      return player.recorder.start(path, source) ? "ok " + path : "error could not record to " + path;
+    }
+    if (argument == "stop") {
+      return player.recorder.stop() ? "ok" : "error recording failed";
+    }
+    char reply[512];
+    std::snprintf(reply, sizeof(reply),
+                  "ok %s source=%s file=%s seconds=%.1f overruns=%llu dropped=%.2f ring=%.2f peak=%.2f",
+                  player.recorder.recording() ? "recording" : "stopped",
+                  player.recorder.recordingSource() == block_recorder::INPUTS ? "inputs" : "outputs",
+                  player.recorder.path().empty() ? "-" : player.recorder.path().c_str(),
+                  player.recorder.recordedSeconds(), (unsigned long long)player.recorder.overrunCount(),
+                  player.recorder.droppedSeconds(), player.recorder.ringFill(), player.recorder.peakRingFill());
+    return reply;
+  } else if (command == "quit") {
+    quitRequested.store(true);
+  } else {
+    return "error unknown command: " + command;
+  }
+  return "ok";
+}
+
+int main(int argc, char* argv[]) {
+  player_config config;
+  if (!parseArgs(argc, argv, config)) return 1;
+  auto setting = [&](const std::string& key, const std::string& fallback) { return config.get(key, fallback); };
+
+  if (isTrue(setting("verify-routing", "off"))) {
+    routing_verifier verifier;
+    return verifier.run() ? 0 : 1;
+  }
+
+  player_core player;
+  device_settings device = player.deviceSettings();
+  if (!config.readDevice(device)) return 1;
+  player.applyDevice(device);
+  player.setSourceAudioFolder(setting("folder", "../adm-allo-player/sourceAudio/"));
+  player.setCorrectionFilterFile(setting("correction", ""));
+  player.setInitialFile(setting("file", ""));
+  player.onInit();
+  player.gain = std::min(std::max((float)std::atof(setting("gain", "0.5").c_str()), 0.0f), 1.0f);
+  player.loop = isTrue(setting("loop", "on"));
+  player.liveInput.store(player.inputChannels > 0 && isTrue(setting("live", "off")));
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+
+  std::string format = setting("format", "float");
+  if (format != "float" && format != "pcm24") {
+    std::cerr << "✗ ERROR: Unknown sample format: " << format << " (float / pcm24)" << std::endl;
+    return 1;
+  }
+  bw64_writer::Format fileFormat = format == "pcm24" ? bw64_writer::PCM24 : bw64_writer::FLOAT32;
+
+  std::string renderPath = setting("render", "");
+  if (!renderPath.empty()) {
+    offline_renderer renderer;
+    renderer.format = fileFormat;
+    return renderer.run(player, renderPath, &quitRequested) ? 0 : 1;
+  }
+  player.recorder.format = fileFormat;
+  player.recorder.preallocateMinutes = (float)std::atof(setting("prealloc", "0").c_str());
+
+  AudioIO audio;
+  audio.init(playerAudioCallback, &player, player.audioBlockSize, player.audioSampleRate, player.expectedChannels,
+             player.inputChannels);
+  if (!audio.open()) {
+    std::cerr << "✗ ERROR: Could not open the audio device" << std::endl;
+    return 1;
+  }
+  player.applyPendingRate(audio);  // The startup file's sample rate
+
+  control_socket control;
+  std::string socketPath = setting("socket", control_socket::defaultPath());
+  if (socketPath != "off") control.open(socketPath);
+
+  std::signal(SIGPIPE, SIG_IGN);  // Clients that hang up mid-reply
+
+  std::cout << "\n=== Headless Audio Configuration ===" << std::endl;
+  std::cout << "Output channels: " << player.expectedChannels << std::endl;
+  std::cout << "Input channels: " << player.inputChannels << (player.liveInput.load() ? " (live)" : "") << std::endl;
+  std::cout << "Sample rate: " << player.audioSampleRate << " Hz" << std::endl;
+  std::cout << "Buffer size: " << player.audioBlockSize << " frames" << std::endl;
+
+  if (!audio.start()) {
+    std::cerr << "✗ ERROR: Could not start audio" << std::endl;
+    return 1;
+  }
+  if (isTrue(setting("play", "off")) && player.soundFile.opened()) player.playing = true;
+  std::cout << (player.liveInput.load() ? "▶ Live input" : player.playing ? "▶ Playing audio" : "Ready (stopped)") << std::endl;
+
+  while (!quitRequested.load()) {
+    control.poll(200, [&](const std::string& line) { return runCommand(player, line); });
+    player.applyPendingRate(audio);  // After a load at another rate
+    player.matchCorrectionBlock();   // Device blocks the correction partitions don't fit
+    player.checkLatency();
+  }
+
+  std::cout << "Shutting down" << std::endl;
+  player.playing = false;
+  audio.stop();
+  player.recorder.stop();
+  audio.close();
+  return 0;
+}
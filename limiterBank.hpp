@@ -0,0 +1,194 @@
+/*
+  Speaker Protection: per-output lookahead peak limiter
+
+  One brickwall limiter per output, processed channel-parallel on the
+  frame-major output block (see biquadBank.hpp). For every lane:
+  - target gain = threshold / |x| for samples above threshold
+  - a sliding minimum over the lookahead window (van Herk / Gil-Werman:
+    block suffix minima + running prefix minimum, ~3 ops per sample)
+    holds the lowest target; release back toward unity is exponential
+  - the held gain is smoothed with a moving average of the same length
+  - audio is delayed by the lookahead, so the averaged gain has fully
+    reached the target when the peak sample leaves the delay line
+
+  Linked mode shares one sidechain: every lane uses the lowest target of
+  all lanes, keeping the spatial image stable under limiting.
+
+  Gain reduction is published per output as relaxed atomics once per
+  block, so the meter UI can read it without locks.
+*/
+
+#ifndef LIMITER_BANK_HPP
+#define LIMITER_BANK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+struct limiter_bank {
+  std::atomic<bool> enabled{true};  // Written by the GUI, read by the audio thread
+  std::atomic<float> thresholdDb{-1.0f};
+  std::atomic<float> releaseMs{80.0f};
+  std::atomic<bool> linked{false};
+
+  // Preallocate all state; lookahead is fixed after prepare()
+  void prepare(int numLanes, double sampleRate, float lookaheadMs = 1.5f) {
+    lanes = numLanes;
+    rate = sampleRate;
+    lookahead = std::max(1, (int)std::lround(lookaheadMs * 0.001 * sampleRate));
+
+    window = lookahead + 1;
+
+    delayLine.assign((size_t)lookahead * lanes, 0.0f);
+    gainHistory.assign((size_t)lookahead * lanes, 1.0f);
+    gainSum.assign(lanes, (float)lookahead);
+    heldGain.assign(lanes, 1.0f);
+    targets.assign((size_t)window * lanes, 1.0f);
+    suffixMin.assign((size_t)window * lanes, 1.0f);
+    prefixMin.assign(lanes, 1.0f);
+    blockMinGain.assign(lanes, 1.0f);
+    gainReduction.reset(new std::atomic<float>[lanes]);
+    for (int c = 0; c < lanes; c++) gainReduction[c].store(1.0f);
+    position = 0;
+  }
+
+  void reset() {
+    std::fill(delayLine.begin(), delayLine.end(), 0.0f);
+    std::fill(gainHistory.begin(), gainHistory.end(), 1.0f);
+    std::fill(gainSum.begin(), gainSum.end(), (float)lookahead);
+    std::fill(heldGain.begin(), heldGain.end(), 1.0f);
+    std::fill(targets.begin(), targets.end(), 1.0f);
+    std::fill(suffixMin.begin(), suffixMin.end(), 1.0f);
+    std::fill(prefixMin.begin(), prefixMin.end(), 1.0f);
+    position = 0;
+    windowPosition = 0;
+  }
+
+  int latencyFrames() const { return lookahead; }
+
+  // Lowest gain applied to an output during the last block (1 = no reduction)
+  float currentGain(int lane) const {
+    return (lane >= 0 && lane < lanes) ? gainReduction[lane].load(std::memory_order_relaxed) : 1.0f;
+  }
+
+  // Limit a frame-major block (frames x lanes) in place
+  void process(float* block, int frames) {
+    if (!enabled.load(std::memory_order_relaxed) || lanes == 0) {
+      wasEnabled = false;
+      return;
+    }
+    if (!wasEnabled) {
+      reset();  // Don't replay stale audio from the delay line
+      wasEnabled = true;
+    }
+
+    float threshold = std::pow(10.0f, thresholdDb.load(std::memory_order_relaxed) / 20.0f);
+    float release = 1.0f - std::exp(-1.0f / (0.001f * releaseMs.load(std::memory_order_relaxed) * (float)rate));
+    bool link = linked.load(std::memory_order_relaxed);
+    float inverseLength = 1.0f / (float)lookahead;
+
+    float* __restrict held = heldGain.data();
+    float* __restrict sum = gainSum.data();
+    float* __restrict prefix = prefixMin.data();
+    float* __restrict minGain = blockMinGain.data();
+    for (int c = 0; c < lanes; c++) minGain[c] = 1.0f;
+
+    for (int n = 0; n < frames; n++) {
+      float* __restrict x = block + (size_t)n * lanes;
+      float* __restrict delayed = &delayLine[(size_t)position * lanes];
+      float* __restrict history = &gainHistory[(size_t)position * lanes];
+      float* __restrict tgt = &targets[(size_t)windowPosition * lanes];
+
+      // Sidechain: gain needed to bring the incoming sample under threshold
+      for (int c = 0; c < lanes; c++) {
+        float peak = std::fabs(x[c]);
+        tgt[c] = peak > threshold ? threshold / peak : 1.0f;
+      }
+      if (link) {
+        float shared = 1.0f;
+        for (int c = 0; c < lanes; c++) shared = tgt[c] < shared ? tgt[c] : shared;
+        for (int c = 0; c < lanes; c++) tgt[c] = shared;
+      }
+
+      // Minimum target over the last lookahead + 1 frames: suffix minimum of
+      // the previous window block combined with the prefix of the current one
+      const float* __restrict suffix =
+          windowPosition + 1 < window ? &suffixMin[(size_t)(windowPosition + 1) * lanes] : nullptr;
+      for (int c = 0; c < lanes; c++) {
+        prefix[c] = tgt[c] < prefix[c] ? tgt[c] : prefix[c];
+        float windowMin = prefix[c];
+        if (suffix) windowMin = suffix[c] < windowMin ? suffix[c] : windowMin;
+
+        // Release toward unity, never above the window minimum
+        float released = held[c] + (1.0f - held[c]) * release;
+        held[c] = windowMin < released ? windowMin : released;
+
+        // Moving average over the lookahead window smooths the attack
+        sum[c] += held[c] - history[c];
+        history[c] = held[c];
+        float gain = sum[c] * inverseLength;
+        gain = gain < 1.0f ? gain : 1.0f;
+        minGain[c] = gain < minGain[c] ? gain : minGain[c];
+
+        // Swap the incoming sample into the delay line, output the delayed one
+        float in = x[c];
+        x[c] = delayed[c] * gain;
+        delayed[c] = in;
+      }
+
+      position = (position + 1 == lookahead) ? 0 : position + 1;
+      if (++windowPosition == window) {
+        finishWindowBlock();
+        windowPosition = 0;
+      }
+    }
+
+    // Resync the running sums so float error can't accumulate
+    for (int c = 0; c < lanes; c++) sum[c] = 0.0f;
+    for (int i = 0; i < lookahead; i++) {
+      const float* history = &gainHistory[(size_t)i * lanes];
+      for (int c = 0; c < lanes; c++) sum[c] += history[c];
+    }
+
+    for (int c = 0; c < lanes; c++) {
+      gainReduction[c].store(minGain[c], std::memory_order_relaxed);
+    }
+  }
+
+private:
+  int lanes = 0;
+  double rate = 48000.0;
+  int lookahead = 1;
+  int window = 2;           // Sliding-minimum length (lookahead + 1)
+  int position = 0;         // Delay line / moving average position
+  int windowPosition = 0;   // Position in the current sliding-minimum block
+  bool wasEnabled = false;
+
+  std::vector<float> delayLine;    // lookahead x lanes (ring)
+  std::vector<float> gainHistory;  // lookahead x lanes (ring, moving average window)
+  std::vector<float> gainSum;      // Running sum of gainHistory per lane
+  std::vector<float> heldGain;
+  std::vector<float> targets;      // window x lanes, current sliding-minimum block
+  std::vector<float> suffixMin;    // window x lanes, suffix minima of the previous block
+  std::vector<float> prefixMin;    // Running minimum of the current block
+  std::vector<float> blockMinGain;
+  std::unique_ptr<std::atomic<float>[]> gainReduction;
+
+  // A block of targets is complete: precompute its suffix minima, restart the prefix
+  void finishWindowBlock() {
+    float* last = &suffixMin[(size_t)(window - 1) * lanes];
+    const float* lastTarget = &targets[(size_t)(window - 1) * lanes];
+    for (int c = 0; c < lanes; c++) last[c] = lastTarget[c];
+    for (int i = window - 2; i >= 0; i--) {
+      float* __restrict dst = &suffixMin[(size_t)i * lanes];
+      const float* __restrict next = &suffixMin[(size_t)(i + 1) * lanes];
+      const float* __restrict tgt = &targets[(size_t)i * lanes];
+      for (int c = 0; c < lanes; c++) dst[c] = tgt[c] < next[c] ? tgt[c] : next[c];
+    }
+    for (int c = 0; c < lanes; c++) prefixMin[c] = 1.0f;
+  }
+};
+
+#endif // LIMITER_BANK_HPP
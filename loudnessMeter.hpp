@@ -0,0 +1,388 @@
+/*
+  Loudness and true-peak metering (EBU R128 / ITU-R BS.1770-4)
+
+  onSound only writes the output block into the audio tap (audioTap.hpp).
+  A worker thread subscribed to the tap does the analysis; if it falls too
+  far behind, it skips blocks rather than being waited for, and filter
+  history restarts after the gap so the discontinuity doesn't read as a
+  true peak. Analysis:
+  - true peak per output: 4x polyphase oversampling (48-tap windowed-sinc
+    interpolator, 12 taps per phase), held until reset
+  - K-weighting (BS.1770 pre-filter shelf + RLB high-pass) on a
+    channel-parallel biquad bank (see biquadBank.hpp)
+  - weighted mean square in 100 ms steps; momentary (400 ms) and
+    short-term (3 s) loudness are sliding windows over those steps
+  - integrated loudness gates the 400 ms blocks (75% overlap) at -70 LUFS
+    absolute and -10 LU relative. Blocks are kept in a 0.1 LU histogram,
+    so memory stays bounded for any program length.
+
+  Channel weights choose what counts toward loudness: 1.0 for the dome
+  speakers, 0 for the sub (BS.1770 excludes LFE) and unmapped outputs.
+
+  Results reach the GUI through a triple buffer.
+*/
+
+#ifndef LOUDNESS_METER_HPP
+#define LOUDNESS_METER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "audioTap.hpp"
+#include "biquadBank.hpp"
+#include "meterKernel.hpp"
+#include "tripleBuffer.hpp"
+
+constexpr float LOUDNESS_FLOOR = -120.0f;  // "No measurement yet" in LUFS / dBTP
+
+struct loudness_snapshot {
+  float momentary = LOUDNESS_FLOOR;     // LUFS, 400 ms window
+  float shortTerm = LOUDNESS_FLOOR;     // LUFS, 3 s window
+  float integrated = LOUDNESS_FLOOR;    // LUFS, gated, since reset
+  float maxMomentary = LOUDNESS_FLOOR;
+  float maxShortTerm = LOUDNESS_FLOOR;
+  float maxTruePeak = LOUDNESS_FLOOR;   // dBTP over all outputs
+  std::vector<float> truePeak;          // dBTP per output, held since reset
+  double seconds = 0.0;                 // Program time analyzed since reset
+};
+
+// 4x oversampling interpolator for true-peak detection
+struct true_peak_filter {
+  static constexpr int PHASES = 4;
+  static constexpr int TAPS = 12;  // Per phase
+  float coeffs[PHASES][TAPS];
+
+  // Blackman-windowed sinc, cutoff at the original Nyquist; each phase
+  // normalized to unity DC gain
+  void design() {
+    const int length = PHASES * TAPS;
+    const double center = (length - 1) / 2.0;
+    for (int p = 0; p < PHASES; p++) {
+      double sum = 0.0;
+      for (int t = 0; t < TAPS; t++) {
+        int k = p + PHASES * t;
+        double x = (k - center) / PHASES;
+        double sinc = std::sin(M_PI * x) / (M_PI * x);
+        double w = 0.42 - 0.5 * std::cos(2.0 * M_PI * k / (length - 1)) +
+                   0.08 * std::cos(4.0 * M_PI * k / (length - 1));
+        coeffs[p][t] = (float)(sinc * w);
+        sum += sinc * w;
+      }
+      for (int t = 0; t < TAPS; t++) coeffs[p][t] = (float)(coeffs[p][t] / sum);
+    }
+  }
+};
+
+struct loudness_meter {
+  std::atomic<bool> enabled{true};
+
+  ~loudness_meter() { stop(); }
+
+  // Subscribe to the tap, allocate everything and start the worker.
+  // weights: one per tap channel. Must be called before audio starts.
+  void prepare(audio_tap& source, double sampleRate, const std::vector<float>& weights) {
+    stop();
+    tap = &source;
+    consumer = tap->subscribe("Loudness");
+    channels = tap->numChannels();
+    maxFrames = tap->maxBlockFrames();
+    rate = sampleRate;
+    lanes = paddedLanes(channels);
+
+    // K-weighting, stage 1 (shelf) + stage 2 (RLB high-pass)
+    kWeighting.init(lanes, 2);
+    biquad_coeffs shelf = kWeightingShelf(rate), highpass = kWeightingHighpass(rate);
+    for (int c = 0; c < lanes; c++) {
+      kWeighting.set(0, c, shelf);
+      kWeighting.set(1, c, highpass);
+    }
+    frameBlock.assign((size_t)maxFrames * lanes, 0.0f);
+    channelWeights.assign(lanes, 0.0f);
+    for (int c = 0; c < channels && c < (int)weights.size(); c++) channelWeights[c] = weights[c];
+
+    stepFrames = std::max(1, (int)std::lround(0.1 * rate));
+    stepSum.assign(lanes, 0.0);
+
+    truePeak.design();
+    tpHistory.assign((size_t)channels * (true_peak_filter::TAPS - 1), 0.0f);
+    tpWork.assign(true_peak_filter::TAPS - 1 + maxFrames, 0.0f);
+    tpAccum.assign(maxFrames, 0.0f);
+    heldTruePeak.assign(channels, 0.0f);
+
+    histogramCount.assign(HISTOGRAM_BINS, 0);
+    histogramEnergy.assign(HISTOGRAM_BINS, 0.0);
+
+    snapshots.init([this](loudness_snapshot& s) { s.truePeak.assign(channels, LOUDNESS_FLOOR); });
+    resetAnalysis();
+
+    if (consumer < 0) {
+      std::cerr << "⚠ WARNING: Audio tap has no free consumer slot, loudness metering disabled" << std::endl;
+      return;
+    }
+    quit.store(false);
+    worker = std::thread([this] { workerLoop(); });
+  }
+
+  void stop() {
+    quit.store(true);
+    if (worker.joinable()) worker.join();
+  }
+
+  // GUI thread: newest results
+  const loudness_snapshot& latest() {
+    snapshots.update();
+    return snapshots.readBuffer();
+  }
+
+  // GUI thread: restart integrated loudness, maxima and true-peak hold
+  void requestReset() { resetRequested.store(true); }
+
+  // Blocks dropped because the analysis fell a full tap ring behind
+  uint64_t overflowCount() const { return consumer >= 0 && tap ? tap->overflows(consumer) : 0; }
+
+  static float toLufs(double meanSquare) {
+    return meanSquare > 0.0 ? std::max((float)(-0.691 + 10.0 * std::log10(meanSquare)), LOUDNESS_FLOOR)
+                            : LOUDNESS_FLOOR;
+  }
+
+private:
+  static constexpr int MOMENTARY_STEPS = 4;   // 400 ms
+  static constexpr int SHORT_TERM_STEPS = 30; // 3 s
+  static constexpr float HISTOGRAM_MIN = -70.0f;  // Absolute gate, LUFS
+  static constexpr float HISTOGRAM_STEP = 0.1f;   // LU per bin
+  static constexpr int HISTOGRAM_BINS = 800;      // -70 .. +10 LUFS
+
+  int channels = 0;
+  int lanes = 0;
+  int maxFrames = 0;
+  double rate = 48000.0;
+
+  audio_tap* tap = nullptr;
+  int consumer = -1;
+
+  std::thread worker;
+  std::atomic<bool> quit{false};
+  std::atomic<bool> resetRequested{false};
+  triple_buffer<loudness_snapshot> snapshots;
+
+  // Worker-thread state
+  biquad_bank kWeighting;
+  std::vector<float> frameBlock;      // maxFrames x lanes
+  std::vector<float> channelWeights;  // Per lane
+  int stepFrames = 4800;
+  int stepPosition = 0;
+  std::vector<double> stepSum;        // Per lane sum of squares in the current step
+  double stepEnergy[SHORT_TERM_STEPS];  // Weighted mean square of recent steps (ring)
+  int stepCount = 0;                  // Steps completed since reset
+  uint64_t framesAnalyzed = 0;
+
+  true_peak_filter truePeak;
+  std::vector<float> tpHistory;       // channels x (TAPS - 1)
+  std::vector<float> tpWork;
+  std::vector<float> tpAccum;
+  std::vector<float> heldTruePeak;    // Linear
+
+  std::vector<uint64_t> histogramCount;
+  std::vector<double> histogramEnergy;
+  float momentary = LOUDNESS_FLOOR, shortTerm = LOUDNESS_FLOOR;
+  float maxMomentary = LOUDNESS_FLOOR, maxShortTerm = LOUDNESS_FLOOR;
+
+  // BS.1770-4 K-weighting, derived for any sample rate
+  static biquad_coeffs kWeightingShelf(double sampleRate) {
+    const double f0 = 1681.974450955533, gainDb = 3.999843853973347, q = 0.7071752369554196;
+    double k = std::tan(M_PI * f0 / sampleRate);
+    double vh = std::pow(10.0, gainDb / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    return biquad_coeffs::normalize(vh + vb * k / q + k * k, 2.0 * (k * k - vh), vh - vb * k / q + k * k,
+                                    1.0 + k / q + k * k, 2.0 * (k * k - 1.0), 1.0 - k / q + k * k);
+  }
+
+  static biquad_coeffs kWeightingHighpass(double sampleRate) {
+    const double f0 = 38.13547087602444, q = 0.5003270373238773;
+    double k = std::tan(M_PI * f0 / sampleRate);
+    return biquad_coeffs::normalize(1.0, -2.0, 1.0, 1.0 + k / q + k * k, 2.0 * (k * k - 1.0),
+                                    1.0 - k / q + k * k);
+  }
+
+  void resetAnalysis() {
+    kWeighting.reset();
+    std::fill(stepSum.begin(), stepSum.end(), 0.0);
+    std::fill(std::begin(stepEnergy), std::end(stepEnergy), 0.0);
+    stepPosition = 0;
+    stepCount = 0;
+    framesAnalyzed = 0;
+    std::fill(tpHistory.begin(), tpHistory.end(), 0.0f);
+    std::fill(heldTruePeak.begin(), heldTruePeak.end(), 0.0f);
+    std::fill(histogramCount.begin(), histogramCount.end(), 0);
+    std::fill(histogramEnergy.begin(), histogramEnergy.end(), 0.0);
+    momentary = shortTerm = maxMomentary = maxShortTerm = LOUDNESS_FLOOR;
+  }
+
+  void workerLoop() {
+    bool listening = false;
+    while (!quit.load()) {
+      if (resetRequested.exchange(false)) {
+        resetAnalysis();
+        publish();
+      }
+      bool on = enabled.load();
+      if (on != listening) {
+        tap->setActive(consumer, on);
+        listening = on;
+      }
+
+      audio_tap_block block;
+      if (!on || !tap->read(consumer, block)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        continue;
+      }
+      if (block.gap) {
+        kWeighting.reset();
+        std::fill(tpHistory.begin(), tpHistory.end(), 0.0f);
+      }
+      analyze(block);
+      tap->release(consumer);
+
+      // Publish once caught up, not after every block of a backlog
+      if (!tap->pending(consumer)) publish();
+    }
+    if (listening) tap->setActive(consumer, false);
+  }
+
+  void analyze(const audio_tap_block& block) {
+    int frames = block.frames;
+    for (int ch = 0; ch < channels; ch++) {
+      measureTruePeak(ch, block.channel(ch), frames);
+    }
+
+    for (int ch = 0; ch < channels; ch++) {
+      const float* src = block.channel(ch);
+      for (int n = 0; n < frames; n++) frameBlock[(size_t)n * lanes + ch] = src[n];
+    }
+    kWeighting.process(frameBlock.data(), frames);
+
+    // Accumulate K-weighted energy in 100 ms steps
+    int n = 0;
+    while (n < frames) {
+      int chunk = std::min(frames - n, stepFrames - stepPosition);
+      double* __restrict sum = stepSum.data();
+      for (int i = n; i < n + chunk; i++) {
+        const float* __restrict x = &frameBlock[(size_t)i * lanes];
+        for (int c = 0; c < lanes; c++) sum[c] += (double)x[c] * x[c];
+      }
+      n += chunk;
+      stepPosition += chunk;
+      if (stepPosition == stepFrames) finishStep();
+    }
+    framesAnalyzed += frames;
+  }
+
+  void measureTruePeak(int ch, const float* samples, int frames) {
+    const int history = true_peak_filter::TAPS - 1;
+    float* hist = &tpHistory[(size_t)ch * history];
+    float* work = tpWork.data();
+    std::copy(hist, hist + history, work);
+    std::copy(samples, samples + frames, work + history);
+
+    float peak, sumSquares;
+    measureBlock(samples, frames, peak, sumSquares);
+    float* acc = tpAccum.data();
+    for (int p = 0; p < true_peak_filter::PHASES; p++) {
+      std::fill(acc, acc + frames, 0.0f);
+      for (int t = 0; t < true_peak_filter::TAPS; t++) {
+        float h = truePeak.coeffs[p][t];
+        const float* __restrict x = work + history - t;
+        float* __restrict y = acc;
+        for (int i = 0; i < frames; i++) y[i] += h * x[i];
+      }
+      float phasePeak;
+      measureBlock(acc, frames, phasePeak, sumSquares);
+      peak = std::max(peak, phasePeak);
+    }
+
+    std::copy(work + frames, work + frames + history, hist);
+    heldTruePeak[ch] = std::max(heldTruePeak[ch], peak);
+  }
+
+  void finishStep() {
+    double energy = 0.0;
+    for (int c = 0; c < lanes; c++) {
+      energy += channelWeights[c] * stepSum[c] / stepFrames;
+      stepSum[c] = 0.0;
+    }
+    stepPosition = 0;
+    stepEnergy[stepCount % SHORT_TERM_STEPS] = energy;
+    stepCount++;
+
+    if (stepCount >= MOMENTARY_STEPS) {
+      double block = windowEnergy(MOMENTARY_STEPS);
+      momentary = toLufs(block);
+      maxMomentary = std::max(maxMomentary, momentary);
+
+      // Every 400 ms window (100 ms hop) is a gating block
+      if (momentary >= HISTOGRAM_MIN) {
+        int bin = std::min((int)((momentary - HISTOGRAM_MIN) / HISTOGRAM_STEP), HISTOGRAM_BINS - 1);
+        histogramCount[bin]++;
+        histogramEnergy[bin] += block;
+      }
+    }
+    if (stepCount >= SHORT_TERM_STEPS) {
+      shortTerm = toLufs(windowEnergy(SHORT_TERM_STEPS));
+      maxShortTerm = std::max(maxShortTerm, shortTerm);
+    }
+  }
+
+  // Mean of the last `steps` step energies
+  double windowEnergy(int steps) const {
+    double sum = 0.0;
+    for (int i = 1; i <= steps; i++) sum += stepEnergy[(stepCount - i) % SHORT_TERM_STEPS];
+    return sum / steps;
+  }
+
+  // Two-stage gating over the block histogram
+  float integratedLoudness() const {
+    uint64_t count = 0;
+    double energy = 0.0;
+    for (int b = 0; b < HISTOGRAM_BINS; b++) {
+      count += histogramCount[b];
+      energy += histogramEnergy[b];
+    }
+    if (count == 0) return LOUDNESS_FLOOR;
+
+    float relativeGate = toLufs(energy / count) - 10.0f;
+    int first = std::max(0, (int)((relativeGate - HISTOGRAM_MIN) / HISTOGRAM_STEP));
+    count = 0;
+    energy = 0.0;
+    for (int b = first; b < HISTOGRAM_BINS; b++) {
+      count += histogramCount[b];
+      energy += histogramEnergy[b];
+    }
+    return count > 0 ? toLufs(energy / count) : LOUDNESS_FLOOR;
+  }
+
+  void publish() {
+    loudness_snapshot& s = snapshots.writeBuffer();
+    s.momentary = stepCount >= MOMENTARY_STEPS ? momentary : LOUDNESS_FLOOR;
+    s.shortTerm = stepCount >= SHORT_TERM_STEPS ? shortTerm : LOUDNESS_FLOOR;
+    s.integrated = integratedLoudness();
+    s.maxMomentary = maxMomentary;
+    s.maxShortTerm = maxShortTerm;
+    float overall = 0.0f;
+    for (int ch = 0; ch < channels; ch++) {
+      s.truePeak[ch] = heldTruePeak[ch] > 0.0f
+                           ? std::max(20.0f * std::log10(heldTruePeak[ch]), LOUDNESS_FLOOR)
+                           : LOUDNESS_FLOOR;
+      overall = std::max(overall, heldTruePeak[ch]);
+    }
+    s.maxTruePeak = overall > 0.0f ? std::max(20.0f * std::log10(overall), LOUDNESS_FLOOR) : LOUDNESS_FLOOR;
+    s.seconds = framesAnalyzed / rate;
+    snapshots.publish();
+  }
+};
+
+#endif // LOUDNESS_METER_HPP
@@ -6,24 +6,30 @@ Includes real-time dB meters for all 54 channels.
 */
 
 #include "mainplayer.hpp"
+#include "playerConfig.hpp"
 
 struct app : App {
   adm_player adm_player_instance;
+  double appliedFps = 0.0;
   app() {
     adm_player_instance.toggleGUI(true); // disable GUI
     adm_player_instance.setSourceAudioFolder("../adm-allo-player/sourceAudio/");
+    // Optional per-speaker room correction FIRs (multichannel WAV, channel N -> output N)
+    // adm_player_instance.setCorrectionFilterFile("../adm-allo-player/correctionFilters/allosphere_fir.wav");
+    // Audio device settings come from --samplerate / --blocksize / --outputs /
+    // --inputs or a --config file (see playerConfig.hpp). For live input, open
+    // e.g. 56 inputs at a 64-frame buffer and enable "Live Input" in the GUI.
   }
   void onInit() override {
     adm_player_instance.onInit();
-    // adm_player_instance.configureAudio(48000,  // Sample rate (adjust to match your file)
-    //                  512,    // Buffer size
-    //                  60,     // Output channels
-    //                  0);     // Input channels
+    // Reopen the device at the first file's rate if it differs (matchrate)
+    adm_player_instance.applyPendingRate(audioIO());
 
   std::cout << "\n=== Audio Configuration ===" << std::endl;
-  std::cout << "Output channels: 60" << std::endl;
-  std::cout << "Sample rate: 48000 Hz" << std::endl;
-  std::cout << "Buffer size: 512 frames" << std::endl;
+  std::cout << "Output channels: " << adm_player_instance.expectedChannels << std::endl;
+  std::cout << "Input channels: " << adm_player_instance.inputChannels << std::endl;
+  std::cout << "Sample rate: " << adm_player_instance.audioSampleRate << " Hz" << std::endl;
+  std::cout << "Buffer size: " << adm_player_instance.audioBlockSize << " frames" << std::endl;
   std::cout << "\nKeyboard shortcuts:" << std::endl;
   std::cout << "  SPACE - Play/Pause" << std::endl;
   std::cout << "  R - Rewind" << std::endl;
@@ -35,6 +41,16 @@ struct app : App {
   }
   void onDraw(Graphics& g) override {
     adm_player_instance.onDraw(g);
+    // A file at another sample rate was selected: reopen the device
+    adm_player_instance.applyPendingRate(audioIO());
+    // Device blocks the correction partitions don't fit: partition for them
+    adm_player_instance.matchCorrectionBlock();
+    // Follow the player's adaptive GUI refresh rate
+    double rate = adm_player_instance.guiFrameRate();
+    if (rate != appliedFps) {
+      fps(rate);
+      appliedFps = rate;
+    }
   }
   void onSound(AudioIOData& io) override {
     adm_player_instance.onSound(io);
@@ -42,10 +58,25 @@ struct app : App {
   bool onKeyDown(const Keyboard& k) override {
     return adm_player_instance.onKeyDown(k);
   }
+  // Any window input wakes the GUI from its idle / sleep refresh rate
+  bool onMouseDown(const Mouse&) override { adm_player_instance.wakeGUI(); return true; }
+  bool onMouseUp(const Mouse&) override { adm_player_instance.wakeGUI(); return true; }
+  bool onMouseDrag(const Mouse&) override { adm_player_instance.wakeGUI(); return true; }
+  bool onMouseMove(const Mouse&) override { adm_player_instance.wakeGUI(); return true; }
+  bool onMouseScroll(const Mouse&) override { adm_player_instance.wakeGUI(); return true; }
+  void onResize(int, int) override { adm_player_instance.wakeGUI(); }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
   app myApp;
+  player_config config;
+  device_settings device = myApp.adm_player_instance.deviceSettings();
+  if (!config.parse(argc, argv) || !config.readDevice(device)) {
+    std::cerr << "Usage: mainplayer [--config FILE] [--samplerate HZ] [--blocksize FRAMES] [--outputs N] [--inputs N]"
+              << " [--matchrate on|off]" << std::endl;
+    return 1;
+  }
+  myApp.adm_player_instance.applyDevice(device);
   // adm_player adm_player_instance;
 
   // adm_player_instance.toggleGUI(false); // disable GUI
@@ -55,9 +86,12 @@ int main() {
   // adm_player_instance.onCreate();
 
 
-  // Configure audio for 54 output channels, 0 input channels
-  // Adjust sample rate and buffer size as needed. (samplerate, buffer size, output channels, input channels)
-  myApp.configureAudio(48000, 512, 60, 0); // try 44.1k if there are sampling issuess
+  // Configure audio from the player's device settings (command line / config file)
+  // (samplerate, buffer size, output channels, input channels; 0 inputs = file playback only)
+  myApp.configureAudio(myApp.adm_player_instance.audioSampleRate,
+                       myApp.adm_player_instance.audioBlockSize,
+                       myApp.adm_player_instance.expectedChannels,
+                       myApp.adm_player_instance.inputChannels);
   
   myApp.start();
   return 0;
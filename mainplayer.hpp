@@ -6,54 +6,49 @@
 Plays back a multichannel audio file with all channels mapped to individual outputs.
 Includes GUI controls for playback, pause, loop, and rewind.
 Includes real-time dB meters for all 54 channels.
+
+The audio side (file, routing, DSP, onSound) is player_core (playerCore.hpp);
+this adds the window: ImGui controls, meters and the speaker dome.
 */
 
-#include <algorithm>
-#include <cmath>
-#include <iostream>
+#include <chrono>
+#include <ctime>
+#include <string>
 #include <vector>
 #include "al/app/al_App.hpp"
-#include "al/io/al_File.hpp"
 #include "al/io/al_Imgui.hpp"
-#include "Gamma/SoundFile.h"
-#include "channelMapping.hpp"
-
-using namespace al;
-
-struct adm_player {
-  gam::SoundFile soundFile;
-  uint64_t frameCounter = 0;
-  std::vector<float> buffer;
-
-  // Playback controls
-  bool playing = false;
-  bool loop = true;
-  float gain = 0.5f;
-  bool streamingMode = true;  // Enable streaming for large files
-  uint64_t chunkSize = 60 * 48000;  // 1 minute chunks at 48kHz
-  std::vector<float> audioData;  // Chunked audio data
-  uint64_t currentChunkStart = 0;
-  uint64_t currentChunkFrames = 0;
-
-  // Audio file info
-  int numChannels = 56; //default 
-  int expectedChannels = 60; //default
-  std::string audioFolder;
-  // std::string audioFolder = "../adm-allo-player/sourceAudio/";
-  //std::string audioFileName = "1-swale-allo-render.wav";
-  // selection is done via audioFiles + selectedFileIndex (no single audioFileName string)
-
-  // Metering
-  std::vector<float> channelLevels;  // Linear amplitude for each channel
-  std::vector<float> channelPeaks;   // Peak hold for each channel
-  int peakHoldFrames = 24;           // How long to hold peaks (in render frames)
-  std::vector<int> peakHoldCounters; // Counter for peak hold
-  float meterDecayRate = 0.95f;      // How fast meters decay
+#include "guiThrottle.hpp"
+#include "meterRenderer.hpp"
+#include "playerCore.hpp"
+#include "speakerDome.hpp"
+
+struct adm_player : player_core {
+  // Meter display: decay and peak hold on GUI time (see meterBus.hpp)
+  meter_ballistics meterDisplay;
+  std::chrono::steady_clock::time_point lastMeterUpdate;
   bool showMeters = true;
+  meter_renderer meterView;            // Batched ImDrawList meter rows
+  std::vector<float> meterLimiterGain; // GUI scratch, per output
+
+  // 3D view of the speakers colored by meter level (own window)
+  speaker_dome dome;
+  bool showDome = false;
+  bool domeRings[ChannelMapping::NUM_RINGS] = {true, true, true, true};
+
+  // GUI cost, smoothed (ms of CPU per onDraw / meter section)
+  double guiFrameMs = 0.0;
+  double meterDrawMs = 0.0;
 
-  // File selection
-  std::vector<std::string> audioFiles;  // List of available audio files
-  int selectedFileIndex = 0;            // Currently selected file index
+  // Adaptive refresh: full rate only while someone uses the GUI
+  gui_throttle guiThrottle;
+  bool metersMoving = false;      // Meters / clip LEDs still changing on their own
+
+  // Editor selections
+  bool spectrumRings[ChannelMapping::NUM_RINGS] = {true, true, true, true};
+  int spectrumFocusOutput = 1;    // 1-indexed output shown as a spectrum line
+  int trimEditOutput = 1;         // 1-indexed output shown in the trim editor
+  int eqEditTarget = 0;           // 0-3 = ring groups, 4 = single output
+  int eqEditOutput = 1;           // 1-indexed output when editing a single speaker
 
   //gui 
   bool displayGUI;
@@ -62,156 +57,18 @@ struct adm_player {
     displayGUI = toggle;
   }
 
-  void setSourceAudioFolder(const std::string& folder) {
-    audioFolder = folder;
-  }
-  void scanAudioFiles() {
-    audioFiles.clear();
-    std::string audioDir = al::File::currentPath() + audioFolder;
-
-    std::cout << "Scanning for audio files in: " << audioDir << std::endl;
-
-    try {
-      // Use al::filterInDir to find .wav files
-      al::FileList wavFiles = al::filterInDir(audioDir, [](const al::FilePath& fp) {
-        return al::checkExtension(fp, ".wav");
-      }, false); // false = not recursive
-
-      // Convert FileList to vector of strings
-      for (auto& fp : wavFiles) {
-        audioFiles.push_back(fp.file());
-      }
-
-      // Make ordering deterministic: lexicographic sort (case-sensitive, std::string <)
-      std::sort(audioFiles.begin(), audioFiles.end());
-    } catch (const std::exception& e) {
-      std::cerr << "Error scanning audio directory: " << e.what() << std::endl;
-    }
-
-    std::cout << "Found " << audioFiles.size() << " audio files" << std::endl;
-  }
-
-  // Load a new audio file
-  bool loadAudioFile(const std::string& filename) {
-    std::string audioPath = al::File::currentPath() + audioFolder + filename;
-
-    std::cout << "\n=== Loading new audio file ===" << std::endl;
-    std::cout << "File: " << audioPath << std::endl;
-
-    // Stop playback during load
-    bool wasPlaying = playing;
-    playing = false;
-
-    if (!soundFile.openRead(audioPath)) {
-      std::cerr << "✗ ERROR: Could not open file: " << audioPath << std::endl;
-      return false;
-    }
-
-    std::cout << "✓ Audio file loaded successfully" << std::endl;
-    std::cout << "  Sample rate: " << soundFile.frameRate() << " Hz" << std::endl;
-    std::cout << "  Channels: " << soundFile.channels() << std::endl;
-    std::cout << "  Frame count: " << soundFile.frames() << std::endl;
-    std::cout << "  Duration: " << (double)soundFile.frames() / soundFile.frameRate() << " seconds" << std::endl;
-
-    // For streaming mode, we don't preload data - Gamma SoundFile doesn't load data by default
-    if (streamingMode) {
-      std::cout << "  Streaming mode enabled - data not loaded into memory" << std::endl;
-    }
-    // note: we don't store a single filename string; selection is tracked by audioFiles[selectedFileIndex]
-
-    if (numChannels != expectedChannels) {
-      std::cerr << "⚠ WARNING: Expected " << expectedChannels << " channels but file has "
-                << numChannels << " channels." << std::endl;
-    }
-
-    // For streaming mode, load first chunk
-    if (streamingMode) {
-      loadAudioChunk(0);
-      std::cout << "  Streaming mode enabled - loaded first chunk" << std::endl;
-    }
-    // note: we don't store a single filename string; selection is tracked by audioFiles[selectedFileIndex]
-
-    if (numChannels != expectedChannels) {
-      std::cerr << "⚠ WARNING: Expected " << expectedChannels << " channels but file has "
-                << numChannels << " channels." << std::endl;
-    }
-
-    // Reset playback position
-    frameCounter = 0;
-
-    // Resize buffers for new channel count
-    int framesPerBuffer = 512;
-    buffer.resize(framesPerBuffer * numChannels);
-    channelLevels.resize(expectedChannels, 0.0f);
-    channelPeaks.resize(expectedChannels, 0.0f);
-    peakHoldCounters.resize(expectedChannels, 0);
-
-    // Resume playback if was playing
-    playing = wasPlaying;
-
-    return true;
-  }
-
-  void loadAudioChunk(uint64_t chunkStartFrame) {
-    if (!streamingMode) return;
-
-    // Calculate chunk size in frames (1 minute chunks)
-    uint64_t chunkFrames = chunkSize;
-
-    // Ensure we don't read beyond file end
-    if (chunkStartFrame + chunkFrames > soundFile.frames()) {
-      chunkFrames = soundFile.frames() - chunkStartFrame;
-    }
-
-    // Resize audioData to hold the chunk
-    audioData.resize(chunkFrames * numChannels);
-
-    // Seek to the correct position in the file
-    soundFile.seek(chunkStartFrame, SEEK_SET);
-
-    // Read the chunk data
-    soundFile.read(&audioData[0], chunkFrames);
-
-    // Update current chunk info
-    currentChunkStart = chunkStartFrame;
-    currentChunkFrames = chunkFrames;
-
-    std::cout << "Loaded chunk: frames " << chunkStartFrame << " to " << (chunkStartFrame + chunkFrames - 1)
-              << " (" << chunkFrames << " frames)" << std::endl;
+  void onInit() {
+    prepareView();
+    player_core::onInit();
   }
 
-  void onInit()  {
-    std::cout << "\n=== 54-Channel Audio Player ===" << std::endl;
-    std::cout << "Current path: " << al::File::currentPath() << std::endl;
-
-    // Enable streaming mode for large files
-    streamingMode = true; // should make this dynamically set able 
-    std::cout << "Streaming mode: ENABLED (for large file support)" << std::endl;
-
-    // populate audioFiles from folder and pick selectedFileIndex
-    scanAudioFiles();
-    if (audioFiles.empty()) {
-      std::cerr << "✗ ERROR: No audio files found in: " << al::File::currentPath() + audioFolder << std::endl;
-      std::cerr << "Please update the audioFolder or add files." << std::endl;
-      // quit();
-      return;
-    }
-    if (selectedFileIndex < 0 || selectedFileIndex >= static_cast<int>(audioFiles.size())) selectedFileIndex = 0;
-
-    // Load the selected file (loadAudioFile prints details)
-    if (!loadAudioFile(audioFiles[selectedFileIndex])) {
-      std::cerr << "✗ ERROR: Could not open selected audio file." << std::endl;
-      // quit();
-      return;
-    }
-
-    // Ensure buffers/meters sized (loadAudioFile already resizes but keep safe)
-    int framesPerBuffer = 512;
-    buffer.resize(framesPerBuffer * numChannels);
-    channelLevels.resize(expectedChannels, 0.0f);
-    channelPeaks.resize(expectedChannels, 0.0f);
-    peakHoldCounters.resize(expectedChannels, 0);
-    frameCounter = 0;
+  // Display state sized for the outputs (device settings)
+  void prepareView() {
+    meterDisplay.prepare(expectedChannels);
+    lastMeterUpdate = std::chrono::steady_clock::now();
+    meterView.prepare(expectedChannels);
+    meterLimiterGain.assign(expectedChannels, 1.0f);
+    dome.prepare(expectedChannels);
   }
 
   void onCreate() {
@@ -226,6 +83,18 @@ struct adm_player {
 
   void onDraw(Graphics& g) {
     if (displayGUI) {
+      TRACE_THREAD("gui");
+      if (stateChanged.exchange(false)) guiThrottle.markDirty();
+      // Stopped and nothing changed: the buffers are swapped after onDraw
+      // anyway, so repaint the last frame without building the GUI again
+      if (!guiThrottle.beginFrame(playing, metersMoving)) {
+        TRACE_SCOPE("repaint");
+        renderFrame(g, true);
+        return;
+      }
+      TRACE_SCOPE("onDraw");
+
+      auto frameStart = std::chrono::steady_clock::now();
       imguiBeginFrame();
 
     ImGui::Begin("54-Channel Audio Player");
@@ -266,6 +135,9 @@ struct adm_player {
     ImGui::Text("  File Channels: %d", numChannels);
     ImGui::Text("  Output Channels: %d", expectedChannels);
     ImGui::Text("  Sample Rate: %d Hz", (int)soundFile.frameRate());
+    ImGui::Text("  Device: %d Hz, %d-frame buffer (%.2f ms)%s", (int)audioSampleRate, audioBlockSize,
+                audioBlockSize * 1000.0 / audioSampleRate,
+                soundFile.opened() && soundFile.frameRate() != audioSampleRate ? "  ⚠ rate mismatch" : "");
     ImGui::Text("  Duration: %.2f seconds", (double)soundFile.frames() / soundFile.frameRate());
 
     ImGui::Separator();
@@ -294,254 +166,471 @@ struct adm_player {
     }
 
     if (ImGui::Checkbox("Loop", &loop)) {
-      std::cout << "Loop: " << (loop ? "ON" : "OFF") << std::endl;
-    }
-
-    if (ImGui::Checkbox("Streaming Mode", &streamingMode)) {
-      std::cout << "Streaming Mode: " << (streamingMode ? "ON" : "OFF") << std::endl;
-      // Note: Changing streaming mode requires reloading the file
-      if (soundFile.opened()) {
-        std::cout << "⚠ Note: Restart required for streaming mode change" << std::endl;
-      }
+      rtLog().info(loop ? "Loop: ON" : "Loop: OFF");
     }
 
-    if (ImGui::SliderFloat("Gain", &gain, 0.0f, 1.0f)) {
-      std::cout << "Gain: " << gain << std::endl;
+    bool streaming = streamingMode;
+    if (ImGui::Checkbox("Streaming Mode", &streaming)) {
+      setStreamingMode(streaming);
+      rtLog().info(streamingMode ? "Streaming Mode: ON" : "Streaming Mode: OFF");
     }
 
-    ImGui::Separator();
-    ImGui::Checkbox("Show Channel Meters", &showMeters);
-
-    if (showMeters) {
-      ImGui::Text("Channel Levels (dB):");
-
-      // Display meters in a scrollable area
-      ImGui::BeginChild("Meters", ImVec2(0, 400), true);
-
-      for (int ch = 0; ch < expectedChannels; ch++) {
-        // Convert linear amplitude to dB
-        float levelDB = -120.0f; // Silence floor
-        if (channelLevels[ch] > 0.0f) {
-          levelDB = 20.0f * log10f(channelLevels[ch]);
-        }
-
-        float peakDB = -120.0f;
-        if (channelPeaks[ch] > 0.0f) {
-          peakDB = 20.0f * log10f(channelPeaks[ch]);
-        }
-
-        // Clamp to reasonable display range
-        levelDB = (levelDB < -60.0f) ? -60.0f : levelDB;
-        peakDB = (peakDB < -60.0f) ? -60.0f : peakDB;
-
-        // Normalize to 0-1 range for display (-60dB to 0dB)
-        float levelNorm = (levelDB + 60.0f) / 60.0f;
-        float peakNorm = (peakDB + 60.0f) / 60.0f;
-
-        // Color based on level (green -> yellow -> red)
-        ImVec4 color;
-        if (levelNorm < 0.5f) {
-          color = ImVec4(0.0f, 1.0f, 0.0f, 1.0f); // Green
-        } else if (levelNorm < 0.85f) {
-          color = ImVec4(1.0f, 1.0f, 0.0f, 1.0f); // Yellow
+    if (inputChannels > 0) {
+      bool live = liveInput.load();
+      if (ImGui::Checkbox("Live Input", &live)) {
+        liveInput.store(live);
+        if (live) {
+          rtLog().info("Live Input: ON ({} inputs)", inputChannels);
         } else {
-          color = ImVec4(1.0f, 0.0f, 0.0f, 1.0f); // Red
+          rtLog().info("Live Input: OFF");
         }
+      }
+      if (live) {
+        ImGui::SameLine();
+        ImGui::Text("%d inputs -> channel map (file transport bypassed)", inputChannels);
+      }
+    }
 
-        // Channel label and dB value
-        ImGui::Text("Ch %2d:", ch + 1);
-        ImGui::SameLine(60);
+    ImGui::SliderFloat("Gain", &gain, 0.0f, 1.0f);
+    const char* rampModes[] = {"Linear", "Exponential"};
+    ImGui::Combo("Gain Ramp", &outputGains.rampMode, rampModes, 2);
 
-        // Progress bar for meter
-        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, color);
-        ImGui::ProgressBar(levelNorm, ImVec2(200, 0), "");
-        ImGui::PopStyleColor();
+    ImGui::Text("Channel Trim:");
+    char outputLabel[40];
+    snprintf(outputLabel, sizeof(outputLabel), "Trim Output (1-%d)", expectedChannels);
+    ImGui::InputInt(outputLabel, &trimEditOutput);
+    trimEditOutput = std::max(1, std::min(trimEditOutput, expectedChannels));
+    if (ImGui::SliderFloat("Trim (dB)", &outputGains.trimDb[trimEditOutput - 1], -24.0f, 6.0f, "%.1f")) {
+      outputGains.commit();
+    }
+    if (ImGui::Button("Clear Mute/Solo")) {
+      std::fill(outputGains.mute.begin(), outputGains.mute.end(), 0);
+      std::fill(outputGains.solo.begin(), outputGains.solo.end(), 0);
+      outputGains.commit();
+    }
 
-        ImGui::SameLine();
+    ImGui::Separator();
+    ImGui::Text("Callback Timing:");
+    ImGui::Text("  DSP load: %.1f%% (max %.1f%%) of a %.2f ms buffer", callbackTiming.load() * 100.0f,
+                callbackTiming.maxLoad() * 100.0f, callbackTiming.bufferPeriodMs());
+    ImGui::Text("  Callbacks: %llu, late: %llu, underruns: %llu",
+                (unsigned long long)callbackTiming.callbackCount(), (unsigned long long)callbackTiming.lateCount(),
+                (unsigned long long)callbackTiming.underrunCount());
+    if (checkLatency()) {
+      ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.2f, 1.0f), "  ⚠ 99.9%% load %.0f%% > %.0f%%: raise the buffer size",
+                         callbackTiming.loadPercentile(0.999f) * 100.0f, safeLoad * 100.0f);
+    }
+    {
+      // Duration histogram on a log scale so rare long callbacks stay visible
+      float bins[callback_timer::HISTOGRAM_BINS];
+      for (int b = 0; b < callback_timer::HISTOGRAM_BINS; b++) {
+        bins[b] = std::log10(1.0f + (float)callbackTiming.histogramCount(b));
+      }
+      ImGui::PlotHistogram("##callbackHistogram", bins, callback_timer::HISTOGRAM_BINS, 0,
+                           "duration: 0 - 2 buffer periods (log count)", 0.0f, 7.0f, ImVec2(0, 60));
+    }
+    for (int stage = 0; stage < callback_timer::NUM_STAGES; stage++) {
+      ImGui::Text("  %-20s %.3f ms", callback_timer::STAGE_NAMES[stage],
+                  callbackTiming.stageMs((callback_timer::Stage)stage));
+    }
+    if (ImGui::Button("Reset##timing")) {
+      callbackTiming.requestReset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Write CSV##timing")) {
+      callbackTiming.writeCsv("callback_timing.csv");
+    }
+
+    if (streamingMode && soundFile.opened()) {
+      ImGui::Separator();
+      ImGui::Text("Streaming:");
+      ImGui::Text("  Buffered: %.0f ms of %.0f ms (min %.0f ms)", stream.fillMs(), stream.prefetchMs(),
+                  stream.minFillMs());
+      ImGui::ProgressBar(stream.prefetchMs() > 0.0f ? stream.fillMs() / stream.prefetchMs() : 0.0f,
+                         ImVec2(-1, 0), "");
+      ImGui::Text("  Read latency: p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", stream.readPercentileMs(0.5f),
+                  stream.readPercentileMs(0.95f), stream.readPercentileMs(0.99f), stream.maxReadMs());
+      ImGui::Text("  Throughput: %.1f MB/s (playback needs %.1f MB/s)", stream.readMBps(), stream.requiredMBps());
+      ImGui::Text("  Near-underruns: %llu, underruns: %llu", (unsigned long long)stream.nearUnderrunCount(),
+                  (unsigned long long)stream.underrunCount());
+      ImGui::SameLine();
+      if (ImGui::Button("Reset##stream")) {
+        stream.requestReset();
+      }
+    }
 
-        // Peak indicator (small vertical line)
-        if (peakNorm > 0.01f) {
-          ImGui::Text("|");
-        } else {
-          ImGui::Text(" ");
-        }
+    ImGui::Separator();
+    ImGui::Text("Trace:");
+    if (!trace_recorder::compiledIn) {
+      ImGui::TextDisabled("  Not compiled in (configure with -DADM_TRACE=ON)");
+    } else {
+      bool recording = tracer().active();
+      if (ImGui::Checkbox("Record Trace", &recording)) {
+        if (recording) tracer().start(); else tracer().stop();
+      }
+      ImGui::SameLine();
+      if (ImGui::Button("Write Trace")) {
+        tracer().writeJson("adm_trace.json");
+      }
+      ImGui::TextDisabled("  adm_trace.json: open in ui.perfetto.dev (%d threads)", tracer().threadCount());
+    }
 
+    ImGui::Separator();
+    ImGui::Text("Recording:");
+    if (!recorder.recording()) {
+      char name[64];
+      std::time_t now = std::time(nullptr);
+      std::strftime(name, sizeof(name), "recording_%Y%m%d_%H%M%S.wav", std::localtime(&now));
+      if (ImGui::Button("● Record Outputs")) {
+        recorder.start(name);
+      }
+      if (inputChannels > 0) {
         ImGui::SameLine();
-
-        // Show dB value
-        if (levelDB > -60.0f) {
-          ImGui::Text("%5.1f dB", levelDB);
-        } else {
-          ImGui::Text("  -inf");
+        if (ImGui::Button("● Record Inputs")) {
+          recorder.start(name, block_recorder::INPUTS);
         }
       }
-
-      ImGui::EndChild();
+    } else {
+      if (ImGui::Button("■ Stop Recording")) {
+        recorder.stop();
+      }
+      ImGui::SameLine();
+      ImGui::Text("%s  %.1f s", recorder.path().c_str(), recorder.recordedSeconds());
     }
+    ImGui::ProgressBar(recorder.ringFill(), ImVec2(-1.0f, 0.0f), "ring");
+    ImGui::Text("  Peak ring fill: %.0f%%  Overruns: %llu (%.2f s dropped)", recorder.peakRingFill() * 100.0f,
+                (unsigned long long)recorder.overrunCount(), recorder.droppedSeconds());
 
-    ImGui::End();
-
-    imguiEndFrame();
-    g.clear(0, 0, 0);
-    imguiDraw();
-  }
-  }
-
-  void onSound(AudioIOData& io) {
-    // Check if we have a valid file loaded (Gamma SoundFile doesn't have data member)
-    if (!soundFile.opened()) {
-      // No file loaded, output silence
-      while (io()) {
-        for (int ch = 0; ch < io.channelsOut(); ch++) {
-          io.out(ch) = 0.0f;
-        }
+    ImGui::Separator();
+    ImGui::Text("Room Correction:");
+    if (convolution.ready()) {
+      bool correctionOn = convolution.enabled.load();
+      if (ImGui::Checkbox("Enable Correction Filters", &correctionOn)) {
+        convolution.enabled.store(correctionOn);
       }
-      return;
+      ImGui::Text("  Filters: %d outputs, %d worker threads",
+                  convolution.activeChannels(), convolution.workerCount());
+      ImGui::Text("  Convolution load: %.1f%%", convolution.stageLoad.load() * 100.0f);
+      ImGui::Text("  CPU headroom: %.1f%% (min %.1f%% since the timing reset)",
+                  callbackTiming.headroom() * 100.0f, callbackTiming.minHeadroom() * 100.0f);
+      ImGui::Text("  Deadline misses: %llu, block-size bypasses: %llu (%d-frame partitions)",
+                  (unsigned long long)convolution.deadlineMisses.load(),
+                  (unsigned long long)convolution.blockMismatches.load(), convolution.partitionFrames());
+      ImGui::SameLine();
+      if (ImGui::Button("Reset##convstats")) {
+        convolution.resetStats();
+      }
+    } else {
+      ImGui::Text("  No correction filters loaded");
     }
 
-    uint64_t numFrames = io.framesPerBuffer();
+    ImGui::Separator();
+    bool eqOn = eq.enabled.load();
+    if (ImGui::Checkbox("Parametric EQ", &eqOn)) {
+      eq.enabled.store(eqOn);
+    }
+    if (eqOn) {
+      const char* targets[] = {ChannelMapping::RING_NAMES[0], ChannelMapping::RING_NAMES[1],
+                               ChannelMapping::RING_NAMES[2], ChannelMapping::RING_NAMES[3],
+                               "Single Output"};
+      ImGui::Combo("EQ Target", &eqEditTarget, targets, 5);
+      if (eqEditTarget == 4) {
+        snprintf(outputLabel, sizeof(outputLabel), "Output (1-%d)", expectedChannels);
+        ImGui::InputInt(outputLabel, &eqEditOutput);
+        eqEditOutput = std::max(1, std::min(eqEditOutput, expectedChannels));
+      }
+      eq_band_set& bands = (eqEditTarget == 4) ? eq.speakerBands[eqEditOutput - 1]
+                                               : eq.ringBands[eqEditTarget];
+      bool eqChanged = false;
+      for (int b = 0; b < EQ_BANDS; b++) {
+        eq_band& band = bands[b];
+        ImGui::PushID(b);
+        eqChanged |= ImGui::Checkbox("##on", &band.enabled);
+        ImGui::SameLine();
+        eqChanged |= ImGui::Combo("##type", &band.type, EQ_BAND_TYPE_NAMES, eq_band::NUM_TYPES);
+        eqChanged |= ImGui::DragFloat("Freq", &band.freq, band.freq * 0.01f, 20.0f, 20000.0f, "%.0f Hz");
+        eqChanged |= ImGui::SliderFloat("Gain", &band.gainDb, -18.0f, 18.0f, "%.1f dB");
+        eqChanged |= ImGui::SliderFloat("Q", &band.q, 0.1f, 10.0f, "%.2f");
+        ImGui::PopID();
+      }
+      if (eqChanged) {
+        eq.commit();
+      }
+    }
 
-    // Resize buffer if needed
-    if (buffer.size() < numFrames * numChannels) {
-      buffer.resize(numFrames * numChannels);
+    ImGui::Separator();
+    bool bassOn = bassManagement.enabled.load();
+    if (ImGui::Checkbox("Bass Management", &bassOn)) {
+      bassManagement.enabled.store(bassOn);
+    }
+    if (bassOn) {
+      float crossover = bassManagement.crossoverHz.load();
+      if (ImGui::SliderFloat("Crossover (Hz)", &crossover, 40.0f, 200.0f, "%.0f")) {
+        bassManagement.crossoverHz.store(crossover);
+      }
+      const char* sumLaws[] = {"Unity", "Equal power"};
+      int law = bassManagement.sumLaw.load();
+      if (ImGui::Combo("Bass Summing", &law, sumLaws, 2)) {
+        bassManagement.sumLaw.store(law);
+      }
+      float trim = bassManagement.subTrimDb.load();
+      if (ImGui::SliderFloat("Sub Trim (dB)", &trim, -20.0f, 10.0f, "%.1f")) {
+        bassManagement.subTrimDb.store(trim);
+      }
+      float headroom = bassManagement.headroomDb.load();
+      if (ImGui::SliderFloat("Sub Headroom (dB)", &headroom, 0.0f, 30.0f, "%.1f")) {
+        bassManagement.headroomDb.store(headroom);
+      }
     }
 
-    // If not playing, output silence
-    if (!playing) {
-      while (io()) {
-        for (int ch = 0; ch < io.channelsOut(); ch++) {
-          io.out(ch) = 0.0f;
-        }
+    ImGui::Separator();
+    bool limiterOn = limiter.enabled.load();
+    if (ImGui::Checkbox("Speaker Protection Limiter", &limiterOn)) {
+      limiter.enabled.store(limiterOn);
+    }
+    if (limiterOn) {
+      float threshold = limiter.thresholdDb.load();
+      if (ImGui::SliderFloat("Threshold (dBFS)", &threshold, -24.0f, 0.0f, "%.1f")) {
+        limiter.thresholdDb.store(threshold);
+      }
+      float release = limiter.releaseMs.load();
+      if (ImGui::SliderFloat("Release (ms)", &release, 10.0f, 500.0f, "%.0f")) {
+        limiter.releaseMs.store(release);
       }
-      return;
+      bool linked = limiter.linked.load();
+      if (ImGui::Checkbox("Linked Sidechain", &linked)) {
+        limiter.linked.store(linked);
+      }
+      ImGui::Text("  Lookahead: %d frames", limiter.latencyFrames());
     }
 
-    // Check if we're at the end
-    if (frameCounter >= soundFile.frames()) {
-      if (loop) {
-        frameCounter = 0;
+    ImGui::Separator();
+    const loudness_snapshot& program = loudness.latest();
+    bool loudnessOn = loudness.enabled.load();
+    if (ImGui::Checkbox("Loudness (EBU R128)", &loudnessOn)) {
+      loudness.enabled.store(loudnessOn);
+    }
+    if (loudnessOn) {
+      auto lufs = [](float v) { return v > LOUDNESS_FLOOR ? v : -INFINITY; };
+      ImGui::Text("  Momentary:  %6.1f LUFS  (max %6.1f)", lufs(program.momentary), lufs(program.maxMomentary));
+      ImGui::Text("  Short-term: %6.1f LUFS  (max %6.1f)", lufs(program.shortTerm), lufs(program.maxShortTerm));
+      ImGui::Text("  Integrated: %6.1f LUFS  over %.0f s", lufs(program.integrated), program.seconds);
+      if (program.maxTruePeak > 0.0f) {
+        ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "  Max true peak: %5.1f dBTP", program.maxTruePeak);
       } else {
-        playing = false;
-        while (io()) {
-          for (int ch = 0; ch < io.channelsOut(); ch++) {
-            io.out(ch) = 0.0f;
+        ImGui::Text("  Max true peak: %5.1f dBTP", lufs(program.maxTruePeak));
+      }
+      if (loudness.overflowCount() > 0) {
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "  Analysis overflows: %llu blocks",
+                           (unsigned long long)loudness.overflowCount());
+      }
+      if (ImGui::Button("Reset Loudness")) {
+        loudness.requestReset();
+      }
+    }
+    ImGui::Separator();
+    bool spectrumOn = spectrum.enabled.load();
+    if (ImGui::Checkbox("Spectrum Analyzer", &spectrumOn)) {
+      spectrum.enabled.store(spectrumOn);
+    }
+    if (spectrumOn) {
+      bool settingsChanged = false;
+      settingsChanged |= ImGui::Combo("FFT Size", &spectrum.sizeIndex, SPECTRUM_SIZE_NAMES, NUM_SPECTRUM_SIZES);
+      settingsChanged |= ImGui::SliderFloat("Averaging", &spectrum.averaging, 0.0f, 0.95f, "%.2f");
+
+      // Output selection by ring
+      for (int r = 0; r < ChannelMapping::NUM_RINGS; r++) {
+        if (r > 0) ImGui::SameLine();
+        if (ImGui::Checkbox(ChannelMapping::RING_NAMES[r], &spectrumRings[r])) {
+          for (int ch = 0; ch < (int)spectrum.selected.size(); ch++) {
+            if ((int)ChannelMapping::getRing(ch) == r) spectrum.selected[ch] = spectrumRings[r];
           }
+          settingsChanged = true;
         }
-        return;
       }
-    }
-
-    // Adjust numFrames if we're near the end
-    if (frameCounter + numFrames > soundFile.frames()) {
-      numFrames = soundFile.frames() - frameCounter;
-    }
+      if (ImGui::InputInt("Focus Output", &spectrumFocusOutput)) {
+        spectrumFocusOutput = std::max(1, std::min(spectrumFocusOutput, expectedChannels));
+      }
+      int focus = spectrumFocusOutput - 1;
+      bool focusSelected = spectrum.selected[focus] != 0;
+      ImGui::SameLine();
+      if (ImGui::Checkbox("Analyze", &focusSelected)) {
+        spectrum.selected[focus] = focusSelected;
+        settingsChanged = true;
+      }
+      if (settingsChanged) {
+        spectrum.commit();
+      }
 
-    // Check if we need to load a new chunk
-    if (streamingMode) {
-      uint64_t requiredChunkStart = (frameCounter / chunkSize) * chunkSize;
-      if (requiredChunkStart != currentChunkStart) {
-        loadAudioChunk(requiredChunkStart);
+      const spectrum_snapshot& spectra = spectrum.latest();
+      if (spectra.fftSize > 0) {
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "Out %d, %d-pt FFT", spectrumFocusOutput, spectra.fftSize);
+        ImGui::PlotLines("##spectrum", &spectra.bandsDb[(size_t)focus * SPECTRUM_BANDS], SPECTRUM_BANDS, 0,
+                         overlay, -100.0f, 0.0f, ImVec2(0, 80));
+
+        // Heat map: one row per analyzed output, 20 Hz (left) to Nyquist (right)
+        int rows = 0;
+        for (uint8_t sel : spectra.selected) rows += sel ? 1 : 0;
+        const float rowHeight = 3.0f;
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        float width = std::max(ImGui::GetContentRegionAvail().x, (float)SPECTRUM_BANDS);
+        float bandWidth = width / SPECTRUM_BANDS;
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        int row = 0;
+        for (int ch = 0; ch < (int)spectra.selected.size(); ch++) {
+          if (!spectra.selected[ch]) continue;
+          const float* db = &spectra.bandsDb[(size_t)ch * SPECTRUM_BANDS];
+          float y = origin.y + row * rowHeight;
+          for (int b = 0; b < SPECTRUM_BANDS; b++) {
+            float t = std::min(std::max((db[b] + 100.0f) / 100.0f, 0.0f), 1.0f);
+            ImU32 color = IM_COL32((int)(255 * std::min(1.0f, 2.0f * t)), (int)(255 * std::max(0.0f, 2.0f * t - 1.0f)),
+                                   (int)(96 * (1.0f - t)), 255);
+            float x = origin.x + b * bandWidth;
+            drawList->AddRectFilled(ImVec2(x, y), ImVec2(x + bandWidth, y + rowHeight), color);
+          }
+          row++;
+        }
+        ImGui::Dummy(ImVec2(width, rows * rowHeight));
+        ImGui::Text("  Analyzer load: %.0f%% of one core", spectra.load * 100.0f);
+      }
+      if (spectrum.overflowCount() > 0) {
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "  Analysis overflows: %llu blocks",
+                           (unsigned long long)spectrum.overflowCount());
       }
     }
 
-    // Get pointer to current frame
-    float* frames;
-    if (streamingMode) {
-      uint64_t localFrame = frameCounter - currentChunkStart;
-      frames = &audioData[localFrame * numChannels];
-    } else {
-      // For non-streaming, read directly from file
-      soundFile.seek(frameCounter, SEEK_SET);
-      soundFile.read(buffer.data(), numFrames);
-      frames = buffer.data();
+    if (outputTap.droppedBlocks() > 0) {
+      ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Analysis tap dropped %llu blocks",
+                         (unsigned long long)outputTap.droppedBlocks());
     }
 
-    // Copy interleaved data to buffer
-    for (uint64_t i = 0; i < numFrames * numChannels; i++) {
-      buffer[i] = frames[i];
-    }
+    // Meter ballistics run on GUI time, independent of the audio block size
+    auto meterNow = std::chrono::steady_clock::now();
+    double meterDt = std::chrono::duration<double>(meterNow - lastMeterUpdate).count();
+    lastMeterUpdate = meterNow;
+    meterDisplay.update(meters.consume(), std::min(meterDt, 0.25));
 
-    // Deinterleave and output to all channels WITH REMAPPING
-    int outputChannels = (numChannels < io.channelsOut()) ? numChannels : io.channelsOut();
-    
-    // Reset channel levels for this buffer (size to output channels)
-    std::vector<float> maxLevels(io.channelsOut(), 0.0f);    for (uint64_t frame = 0; frame < numFrames; frame++) {
-      // Clear all outputs first
-      for (int ch = 0; ch < io.channelsOut(); ch++) {
-        io.out(ch, frame) = 0.0f;
-      }
+    ImGui::Separator();
+    ImGui::Checkbox("Show Channel Meters", &showMeters);
 
-      // Apply channel mapping
-      for (int i = 0; i < ChannelMapping::NUM_CHANNELS && i < numChannels; i++) {
-        int fileChannel = ChannelMapping::channelMap[i].first;
-        int outputChannel = ChannelMapping::channelMap[i].second;
+    ImGui::SameLine();
+    ImGui::TextDisabled("GUI %.2f ms/frame, meters %.2f ms", guiFrameMs, meterDrawMs);
+    metersMoving = !meterDisplay.settled() || meterView.clipLit();
 
-        // Bounds check
-        if (fileChannel < numChannels && outputChannel < io.channelsOut()) {
-          float sample = buffer[frame * numChannels + fileChannel] * gain;
-          io.out(outputChannel, frame) = sample;
+    // Refresh rate follows activity; CPU is the GUI thread's, per mode
+    ImGui::Checkbox("Adaptive GUI Refresh", &guiThrottle.enabled);
+    ImGui::SameLine();
+    ImGui::TextDisabled("%s, %.0f fps", gui_throttle::MODE_NAMES[guiThrottle.mode()], guiThrottle.targetFps());
+    if (guiThrottle.enabled) {
+      ImGui::SliderFloat("Meter Refresh (fps)", &guiThrottle.meterFps, 5.0f, 60.0f, "%.0f");
+      ImGui::SliderFloat("Idle Refresh (fps)", &guiThrottle.idleFps, 1.0f, 15.0f, "%.0f");
+    }
+    ImGui::TextDisabled("GUI CPU: active %.1f%%, metering %.1f%%, idle %.1f%%, sleep %.1f%%",
+                        guiThrottle.cpuLoad(gui_throttle::ACTIVE) * 100.0f,
+                        guiThrottle.cpuLoad(gui_throttle::METERING) * 100.0f,
+                        guiThrottle.cpuLoad(gui_throttle::IDLE) * 100.0f,
+                        guiThrottle.cpuLoad(gui_throttle::SLEEP) * 100.0f);
 
-          // Track max level for metering (use output channel index for display)
-          float absSample = fabsf(sample);
-          if (absSample > maxLevels[outputChannel]) {
-            maxLevels[outputChannel] = absSample;
-          }
-        }
+    if (showMeters) {
+      auto meterStart = std::chrono::steady_clock::now();
+      ImGui::Text("Channel Levels (dB):  peak / rms / true peak");
+
+      // Display meters in a scrollable area, drawn as one batch
+      const float meterViewHeight = 400.0f;
+      ImGui::BeginChild("Meters", ImVec2(0, meterViewHeight), true);
+
+      for (int ch = 0; ch < expectedChannels; ch++) meterLimiterGain[ch] = limiter.currentGain(ch);
+      meter_renderer::frame_data rows;
+      rows.channels = expectedChannels;
+      rows.level = meterDisplay.levels.data();
+      rows.peak = meterDisplay.peaks.data();
+      rows.rms = meterDisplay.rms.data();
+      rows.truePeakDb = loudnessOn ? program.truePeak.data() : nullptr;
+      rows.limiterGain = limiter.enabled.load() ? meterLimiterGain.data() : nullptr;
+      rows.mute = outputGains.mute.data();
+      rows.solo = outputGains.solo.data();
+
+      // Mute / solo toggles for speaker checks
+      meter_renderer::click clicked = meterView.draw(rows, meterViewHeight, (float)std::min(meterDt, 0.25));
+      if (clicked.action == meter_renderer::TOGGLE_MUTE) {
+        outputGains.mute[clicked.channel] = !outputGains.mute[clicked.channel];
+        outputGains.commit();
+      } else if (clicked.action == meter_renderer::TOGGLE_SOLO) {
+        outputGains.solo[clicked.channel] = !outputGains.solo[clicked.channel];
+        outputGains.commit();
       }
+
+      ImGui::EndChild();
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - meterStart).count();
+      meterDrawMs += 0.1 * (ms - meterDrawMs);
     }
 
-    // Update meters with max levels from this buffer
-    for (int ch = 0; ch < io.channelsOut(); ch++) {
-      // Smooth decay for current level
-      channelLevels[ch] = channelLevels[ch] * meterDecayRate;
+    ImGui::Checkbox("Show Speaker Dome", &showDome);
 
-      // Update with new max if higher
-      if (maxLevels[ch] > channelLevels[ch]) {
-        channelLevels[ch] = maxLevels[ch];
-      }
+    ImGui::End();
 
-      // Update peak hold
-      if (maxLevels[ch] > channelPeaks[ch]) {
-        channelPeaks[ch] = maxLevels[ch];
-        peakHoldCounters[ch] = peakHoldFrames;
-      } else {
-        // Decay peak hold
-        if (peakHoldCounters[ch] > 0) {
-          peakHoldCounters[ch]--;
-        } else {
-          channelPeaks[ch] = channelPeaks[ch] * meterDecayRate;
+    // Speaker dome: levels from the same meter ballistics, drawn as one mesh
+    if (showDome) {
+      ImGui::SetNextWindowSize(ImVec2(420, 440), ImGuiCond_FirstUseEver);
+      if (ImGui::Begin("Speaker Dome", &showDome, ImGuiWindowFlags_NoBackground)) {
+        for (int r = 0; r < ChannelMapping::NUM_RINGS; r++) {
+          if (r > 0) ImGui::SameLine();
+          ImGui::Checkbox(ChannelMapping::RING_NAMES[r], &domeRings[r]);
         }
+        ImGui::TextDisabled("Drag to orbit, scroll to zoom, hover for levels");
+        dome.layout(meterDisplay.levels.data(), domeRings, std::max(ImGui::GetContentRegionAvail().y, 120.0f));
       }
+      ImGui::End();
     }
 
-    // Fill remaining frames with silence if we read fewer frames
-    for (uint64_t frame = numFrames; frame < io.framesPerBuffer(); frame++) {
-      for (int ch = 0; ch < io.channelsOut(); ch++) {
-        io.out(ch, frame) = 0.0f;
-      }
-    }
+    imguiEndFrame();
+    renderFrame(g, false);
 
-    frameCounter += numFrames;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+    guiFrameMs += 0.1 * (ms - guiFrameMs);
+  }
+  }
+
+  // GL: the dome and the ImGui draw lists; again = the previous frame's
+  // (ImGui keeps its draw data until the next imguiBeginFrame)
+  void renderFrame(Graphics& g, bool again) {
+    TRACE_SCOPE("render");
+    g.clear(0, 0, 0);
+    dome.render(g, again);
+    imguiDraw();
+  }
+
+  // Frame rate the app should run its graphics loop at
+  double guiFrameRate() const {
+    return displayGUI ? guiThrottle.targetFps() : guiThrottle.idleFps;
+  }
+
+  // Window input (mouse, resize): redraw at full rate
+  void wakeGUI() {
+    guiThrottle.wake();
   }
 
   bool onKeyDown(const Keyboard& k) {
+    guiThrottle.wake();
+
     // Play/pause
 
     if (k.key() == ' ') {
       playing = !playing;
-      std::cout << (playing ? "▶ Playing audio" : "⏸ Paused audio") << std::endl;
+      rtLog().info(playing ? "▶ Playing audio" : "⏸ Paused audio");
       //return true;
     }
     // Rewind
     if (k.key() == 'r' || k.key() == 'R') {
       frameCounter = 0;
-      std::cout << "⏮ Rewound to beginning" << std::endl;
+      rtLog().info("⏮ Rewound to beginning");
       //return true;
     }
     // Toggle loop
     if (k.key() == 'l' || k.key() == 'L') {
       loop = !loop;
-      std::cout << "Loop: " << (loop ? "ON" : "OFF") << std::endl;
+      rtLog().info(loop ? "Loop: ON" : "Loop: OFF");
       //return true;
     }
 
@@ -554,15 +643,15 @@ struct adm_player {
         if (idx != selectedFileIndex) {
           selectedFileIndex = idx;
           if (loadAudioFile(audioFiles[selectedFileIndex])) {
-            std::cout << "Loaded file [" << selectedFileIndex + 1 << "]: " << audioFiles[selectedFileIndex] << std::endl;
+            rtLog().info("Loaded file [{}]: {}", selectedFileIndex + 1, audioFiles[selectedFileIndex]);
           } else {
-            std::cerr << "Failed to load file: " << audioFiles[selectedFileIndex] << std::endl;
+            rtLog().error("Failed to load file: {}", audioFiles[selectedFileIndex]);
           }
         } else {
-          std::cout << "Already selected file " << selectedFileIndex + 1 << std::endl;
+          rtLog().info("Already selected file {}", selectedFileIndex + 1);
         }
       } else {
-        std::cerr << "No audio file for key '" << c << "' (index " << idx << " out of range)" << std::endl;
+        rtLog().error("No audio file for key '{}' (index {} out of range)", std::string(1, c), idx);
       }
       //return true;
     }
@@ -571,6 +660,7 @@ struct adm_player {
   }
 
   void onExit() {
+    recorder.stop();
     if (displayGUI) imguiShutdown();
   }
 };
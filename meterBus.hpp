@@ -0,0 +1,151 @@
+/*
+  Meter publication between onSound and onDraw
+
+  The audio thread only measures: per-output block peak and sum of squares.
+  meter_bus accumulates those and publishes a snapshot every block through
+  a lock-free triple buffer. The GUI takes the newest snapshot and
+  acknowledges it; the next block the audio thread sees the acknowledgement
+  and starts a fresh accumulation. No peak is lost between GUI frames, and
+  the audio thread never waits on the GUI.
+
+  meter_ballistics runs on the GUI side: decay, peak hold and dB
+  conversion are driven by elapsed wall-clock time, so meters move the same
+  at any audio buffer size or GUI frame rate.
+*/
+
+#ifndef METER_BUS_HPP
+#define METER_BUS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "tripleBuffer.hpp"
+
+struct meter_snapshot {
+  std::vector<float> peak;         // Max |x| per output over the span
+  std::vector<double> sumSquares;  // Sum of x^2 per output over the span
+  uint64_t frames = 0;             // Frames in the span
+  uint64_t sequence = 0;
+};
+
+struct meter_bus {
+  void prepare(int numChannels) {
+    channels = numChannels;
+    snapshots.init([this](meter_snapshot& s) {
+      s.peak.assign(channels, 0.0f);
+      s.sumSquares.assign(channels, 0.0);
+    });
+    accumPeak.assign(channels, 0.0f);
+    accumSumSquares.assign(channels, 0.0);
+    accumFrames = 0;
+    sequence = 0;
+    acknowledged.store(0);
+  }
+
+  // Audio thread: add one block and publish the running totals
+  void publish(const float* blockPeak, const float* blockSumSquares, int frames) {
+    if (channels == 0) return;
+
+    // Everything accumulated so far reached the GUI: start over
+    if (acknowledged.load(std::memory_order_acquire) == sequence) {
+      for (int ch = 0; ch < channels; ch++) {
+        accumPeak[ch] = 0.0f;
+        accumSumSquares[ch] = 0.0;
+      }
+      accumFrames = 0;
+    }
+
+    for (int ch = 0; ch < channels; ch++) {
+      accumPeak[ch] = blockPeak[ch] > accumPeak[ch] ? blockPeak[ch] : accumPeak[ch];
+      accumSumSquares[ch] += blockSumSquares[ch];
+    }
+    accumFrames += frames;
+
+    meter_snapshot& s = snapshots.writeBuffer();
+    std::copy(accumPeak.begin(), accumPeak.end(), s.peak.begin());
+    std::copy(accumSumSquares.begin(), accumSumSquares.end(), s.sumSquares.begin());
+    s.frames = accumFrames;
+    s.sequence = ++sequence;
+    snapshots.publish();
+  }
+
+  // GUI thread: newest snapshot, or nullptr if nothing new was published
+  const meter_snapshot* consume() {
+    if (!snapshots.update()) return nullptr;
+    const meter_snapshot& s = snapshots.readBuffer();
+    acknowledged.store(s.sequence, std::memory_order_release);
+    return &s;
+  }
+
+private:
+  int channels = 0;
+  triple_buffer<meter_snapshot> snapshots;
+  std::atomic<uint64_t> acknowledged{0};
+
+  // Audio-thread accumulation since the last acknowledged snapshot
+  std::vector<float> accumPeak;
+  std::vector<double> accumSumSquares;
+  uint64_t accumFrames = 0;
+  uint64_t sequence = 0;
+};
+
+struct meter_ballistics {
+  float decayDbPerSecond = 40.0f;  // Level fall-back rate
+  float peakHoldSeconds = 0.25f;   // How long peaks are held before falling
+
+  std::vector<float> levels;       // Linear peak level with decay
+  std::vector<float> peaks;        // Linear held peak
+  std::vector<float> rms;          // Linear RMS of the last snapshot span
+  std::vector<float> holdRemaining;
+
+  void prepare(int numChannels) {
+    levels.assign(numChannels, 0.0f);
+    peaks.assign(numChannels, 0.0f);
+    rms.assign(numChannels, 0.0f);
+    holdRemaining.assign(numChannels, 0.0f);
+  }
+
+  // Advance by dt seconds; snapshot may be nullptr (no new audio data)
+  void update(const meter_snapshot* snapshot, double dt) {
+    float decay = std::pow(10.0f, -decayDbPerSecond * (float)dt / 20.0f);
+    for (size_t ch = 0; ch < levels.size(); ch++) {
+      float blockPeak = 0.0f;
+      if (snapshot && ch < snapshot->peak.size()) {
+        blockPeak = snapshot->peak[ch];
+        rms[ch] = snapshot->frames > 0
+                      ? (float)std::sqrt(snapshot->sumSquares[ch] / (double)snapshot->frames)
+                      : 0.0f;
+      } else {
+        rms[ch] *= decay;  // No new audio (paused / stopped): let RMS fall too
+      }
+
+      levels[ch] *= decay;
+      if (blockPeak > levels[ch]) levels[ch] = blockPeak;
+
+      if (blockPeak > peaks[ch]) {
+        peaks[ch] = blockPeak;
+        holdRemaining[ch] = peakHoldSeconds;
+      } else if (holdRemaining[ch] > 0.0f) {
+        holdRemaining[ch] -= (float)dt;
+      } else {
+        peaks[ch] *= decay;
+      }
+    }
+  }
+
+  // Nothing left to draw: every level, peak and RMS below threshold (linear)
+  bool settled(float threshold = 1e-4f) const {
+    for (size_t ch = 0; ch < levels.size(); ch++) {
+      if (levels[ch] > threshold || peaks[ch] > threshold || rms[ch] > threshold) return false;
+    }
+    return true;
+  }
+
+  static float toDb(float linear, float floorDb = -120.0f) {
+    return linear > 0.0f ? std::max(20.0f * std::log10(linear), floorDb) : floorDb;
+  }
+};
+
+#endif // METER_BUS_HPP
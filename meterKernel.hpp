@@ -0,0 +1,77 @@
+/*
+  Fused metering kernels
+
+  Peak (max |x|) and sum of squares are measured while a block is being
+  written, so metering never costs its own pass over the outputs.
+
+  The max / sum reductions are marked `omp simd`: without it the compiler
+  may not reorder a float sum (no -ffast-math), so the loops would stay
+  scalar. The build enables the pragma with -fopenmp-simd (no OpenMP
+  runtime is linked); compilers without it simply run the scalar loop.
+
+  - copyGainMeasure / copyRampMeasure: routing copy from an interleaved
+    source with constant or ramped gain (see outputGains.hpp)
+  - scatterMeasure: frame-major DSP block back to one planar output
+  - measureBlock: plain measurement when nothing else writes the block
+*/
+
+#ifndef METER_KERNEL_HPP
+#define METER_KERNEL_HPP
+
+#include <cmath>
+#include <cstddef>
+
+// dst[n] = src[n * stride] * gain
+inline void copyGainMeasure(const float* __restrict src, int stride, float* __restrict dst, int frames,
+                            float gain, float& peak, float& sumSquares) {
+  float pk = 0.0f, sq = 0.0f;
+#pragma omp simd reduction(max : pk) reduction(+ : sq)
+  for (int n = 0; n < frames; n++) {
+    float y = src[(size_t)n * stride] * gain;
+    dst[n] = y;
+    float a = std::fabs(y);
+    pk = a > pk ? a : pk;
+    sq += y * y;
+  }
+  peak = pk;
+  sumSquares = sq;
+}
+
+// dst[n] = src[n * stride] * (g0 + delta * shape[n])
+inline void copyRampMeasure(const float* __restrict src, int stride, float* __restrict dst, int frames,
+                            float g0, float delta, const float* __restrict shape,
+                            float& peak, float& sumSquares) {
+  float pk = 0.0f, sq = 0.0f;
+#pragma omp simd reduction(max : pk) reduction(+ : sq)
+  for (int n = 0; n < frames; n++) {
+    float y = src[(size_t)n * stride] * (g0 + delta * shape[n]);
+    dst[n] = y;
+    float a = std::fabs(y);
+    pk = a > pk ? a : pk;
+    sq += y * y;
+  }
+  peak = pk;
+  sumSquares = sq;
+}
+
+// dst[n] = block[n * lanes + lane] (frame-major -> planar)
+inline void scatterMeasure(const float* __restrict block, int lanes, int lane, float* __restrict dst,
+                           int frames, float& peak, float& sumSquares) {
+  copyGainMeasure(block + lane, lanes, dst, frames, 1.0f, peak, sumSquares);
+}
+
+// Measure a planar block in place
+inline void measureBlock(const float* __restrict x, int frames, float& peak, float& sumSquares) {
+  float pk = 0.0f, sq = 0.0f;
+#pragma omp simd reduction(max : pk) reduction(+ : sq)
+  for (int n = 0; n < frames; n++) {
+    float y = x[n];
+    float a = std::fabs(y);
+    pk = a > pk ? a : pk;
+    sq += y * y;
+  }
+  peak = pk;
+  sumSquares = sq;
+}
+
+#endif // METER_KERNEL_HPP
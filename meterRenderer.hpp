@@ -0,0 +1,285 @@
+/*
+  Batched channel meter renderer
+
+  Draws every meter row (label, level bar, RMS and peak-hold ticks, clip
+  LED, peak / RMS / true-peak readouts, mute / solo boxes, limiter gain
+  reduction) straight into the window's ImDrawList instead of submitting
+  ImGui widgets per row:
+  - only rows inside the scrolled view are drawn
+  - all rectangles of a frame go out in one PrimReserve'd batch; text is
+    appended to the same draw list, so the meters cost one draw call
+  - level -> pixel positions come from a lookup table (IEC 60268-18 scale)
+    built once and indexed straight from the linear level's float bits
+    (exponent + top mantissa bits, ~0.05 dB steps), so drawing a row takes
+    no log10; bar colors come from precomputed segment boundaries
+  - row labels are formatted once and peak / RMS / true-peak readouts only when the
+    value changed since the last frame
+  - one invisible button covers the meter area; clicks are hit-tested
+    against the row layout (mute / solo boxes, clip LED reset)
+*/
+
+#ifndef METER_RENDERER_HPP
+#define METER_RENDERER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "al/io/al_Imgui.hpp"
+
+struct meter_renderer {
+  // Row layout (pixels); call prepare() again after changing barWidth
+  float rowHeight = 16.0f;
+  float labelWidth = 44.0f;
+  float barWidth = 200.0f;
+  float clipHoldSeconds = 2.0f;
+
+  // Inputs for one frame, arrays indexed by output (optional ones may be nullptr)
+  struct frame_data {
+    int channels = 0;
+    const float* level = nullptr;        // Linear, with decay
+    const float* peak = nullptr;         // Linear, held
+    const float* rms = nullptr;          // Linear
+    const float* truePeakDb = nullptr;   // dBTP (optional)
+    const float* limiterGain = nullptr;  // Linear, 1 = no reduction (optional)
+    const uint8_t* mute = nullptr;
+    const uint8_t* solo = nullptr;
+  };
+
+  enum Action { NONE, TOGGLE_MUTE, TOGGLE_SOLO };
+  struct click {
+    int channel = -1;
+    Action action = NONE;
+  };
+
+  void prepare(int channels) {
+    clipRemaining.assign(channels, 0.0f);
+    readouts.assign(channels, readout());
+    for (int ch = 0; ch < channels; ch++) snprintf(readouts[ch].label, sizeof(readouts[ch].label), "Ch %2d", ch + 1);
+    buildScale();
+  }
+
+  // Any clip LED still lit (it goes out on its own after clipHoldSeconds)
+  bool clipLit() const {
+    for (float r : clipRemaining) {
+      if (r > 0.0f) return true;
+    }
+    return false;
+  }
+
+  // Draw all meters inside the current (scrolling) child window of height
+  // viewHeight. dt: seconds since the last frame. Returns a mute / solo click.
+  click draw(const frame_data& d, float viewHeight, float dt) {
+    click result;
+    if (d.channels == 0 || (int)readouts.size() < d.channels) return result;
+
+    // Clip LEDs latch on GUI time
+    for (int ch = 0; ch < d.channels; ch++) {
+      if (d.level[ch] >= CLIP_LEVEL) {
+        clipRemaining[ch] = clipHoldSeconds;
+      } else if (clipRemaining[ch] > 0.0f) {
+        clipRemaining[ch] -= dt;
+      }
+    }
+
+    const float barX = labelWidth;
+    const float ledX = barX + barWidth + 4.0f;
+    const float valuesX = ledX + LED_SIZE + 6.0f;
+    const float muteX = valuesX + 3.0f * VALUE_WIDTH + 4.0f;
+    const float soloX = muteX + BUTTON_WIDTH + 4.0f;
+    const float reductionX = soloX + BUTTON_WIDTH + 6.0f;
+    const float totalWidth = reductionX + 60.0f;
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float totalHeight = d.channels * rowHeight;
+
+    // One item for the whole area: layout + hit testing
+    if (ImGui::InvisibleButton("##meters", ImVec2(totalWidth, totalHeight))) {
+      ImVec2 mouse = ImGui::GetMousePos();
+      int row = (int)((mouse.y - origin.y) / rowHeight);
+      float x = mouse.x - origin.x;
+      if (row >= 0 && row < d.channels) {
+        if (x >= muteX && x < muteX + BUTTON_WIDTH) {
+          result.channel = row;
+          result.action = TOGGLE_MUTE;
+        } else if (x >= soloX && x < soloX + BUTTON_WIDTH) {
+          result.channel = row;
+          result.action = TOGGLE_SOLO;
+        } else if (x >= ledX && x < ledX + LED_SIZE) {
+          clipRemaining[row] = 0.0f;
+        }
+      }
+    }
+
+    // Visible rows only
+    float scroll = ImGui::GetScrollY();
+    int first = std::max(0, (int)(scroll / rowHeight));
+    int last = std::min(d.channels, first + (int)(viewHeight / rowHeight) + 2);
+    int rows = last - first;
+    if (rows <= 0) return result;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+    // Rectangles: background, 3 level segments, RMS tick, peak tick, LED, mute, solo
+    drawList->PrimReserve(rows * RECTS_PER_ROW * 6, rows * RECTS_PER_ROW * 4);
+    for (int ch = first; ch < last; ch++) {
+      float y0 = origin.y + ch * rowHeight + 2.0f;
+      float y1 = y0 + rowHeight - 4.0f;
+      float x0 = origin.x + barX;
+      float level = pixelFor(d.level[ch]);
+
+      drawList->PrimRect(ImVec2(x0, y0), ImVec2(x0 + barWidth, y1), COLOR_BACKGROUND);
+      drawList->PrimRect(ImVec2(x0, y0), ImVec2(x0 + std::min(level, greenEnd), y1), COLOR_GREEN);
+      drawList->PrimRect(ImVec2(x0 + greenEnd, y0), ImVec2(x0 + std::max(greenEnd, std::min(level, yellowEnd)), y1),
+                         COLOR_YELLOW);
+      drawList->PrimRect(ImVec2(x0 + yellowEnd, y0), ImVec2(x0 + std::max(yellowEnd, level), y1), COLOR_RED);
+
+      float rms = pixelFor(d.rms[ch]);
+      float peak = pixelFor(d.peak[ch]);
+      drawList->PrimRect(ImVec2(x0 + rms - 1.0f, y1 - 3.0f), ImVec2(x0 + rms + 1.0f, y1), COLOR_RMS);
+      drawList->PrimRect(ImVec2(x0 + peak - 1.0f, y0), ImVec2(x0 + peak + 1.0f, y1),
+                         peak > 0.0f ? COLOR_PEAK : COLOR_BACKGROUND);
+
+      float ledY = origin.y + ch * rowHeight + (rowHeight - LED_SIZE) / 2.0f;
+      drawList->PrimRect(ImVec2(origin.x + ledX, ledY), ImVec2(origin.x + ledX + LED_SIZE, ledY + LED_SIZE),
+                         clipRemaining[ch] > 0.0f ? COLOR_CLIP : COLOR_LED_OFF);
+
+      drawList->PrimRect(ImVec2(origin.x + muteX, y0), ImVec2(origin.x + muteX + BUTTON_WIDTH, y1),
+                         d.mute[ch] ? COLOR_MUTE : COLOR_BUTTON);
+      drawList->PrimRect(ImVec2(origin.x + soloX, y0), ImVec2(origin.x + soloX + BUTTON_WIDTH, y1),
+                         d.solo[ch] ? COLOR_SOLO : COLOR_BUTTON);
+    }
+
+    // Text, appended to the same draw list
+    char text[32];
+    for (int ch = first; ch < last; ch++) {
+      float y = origin.y + ch * rowHeight + (rowHeight - ImGui::GetTextLineHeight()) / 2.0f;
+      readout& r = readouts[ch];
+      drawList->AddText(ImVec2(origin.x, y), COLOR_TEXT, r.label);
+
+      if (d.peak[ch] != r.peak) {
+        r.peak = d.peak[ch];
+        formatDb(r.peakText, sizeof(r.peakText), r.peak > 0.0f ? 20.0f * std::log10(r.peak) : -INFINITY);
+      }
+      drawList->AddText(ImVec2(origin.x + valuesX, y), COLOR_TEXT, r.peakText);
+      if (d.rms[ch] != r.rms) {
+        r.rms = d.rms[ch];
+        formatDb(r.rmsText, sizeof(r.rmsText), r.rms > 0.0f ? 20.0f * std::log10(r.rms) : -INFINITY);
+      }
+      drawList->AddText(ImVec2(origin.x + valuesX + VALUE_WIDTH, y), COLOR_DIM, r.rmsText);
+      if (d.truePeakDb) {
+        if (d.truePeakDb[ch] != r.truePeakDb) {
+          r.truePeakDb = d.truePeakDb[ch];
+          formatDb(r.truePeakText, sizeof(r.truePeakText), r.truePeakDb);
+        }
+        drawList->AddText(ImVec2(origin.x + valuesX + 2.0f * VALUE_WIDTH, y), COLOR_DIM, r.truePeakText);
+      }
+
+      drawList->AddText(ImVec2(origin.x + muteX + 4.0f, y), COLOR_TEXT, "M");
+      drawList->AddText(ImVec2(origin.x + soloX + 4.0f, y), COLOR_TEXT, "S");
+
+      if (d.limiterGain && d.limiterGain[ch] < 0.999f) {
+        snprintf(text, sizeof(text), "GR %4.1f", 20.0f * std::log10(d.limiterGain[ch]));
+        drawList->AddText(ImVec2(origin.x + reductionX, y), COLOR_REDUCTION, text);
+      }
+    }
+    return result;
+  }
+
+private:
+  static constexpr int SCALE_OCTAVES = 12;      // 2^-12 (-72 dB) up to 0 dBFS
+  static constexpr int SCALE_MANTISSA_BITS = 7;  // 128 steps per octave (~0.05 dB)
+  static constexpr int SCALE_STEPS = SCALE_OCTAVES << SCALE_MANTISSA_BITS;
+  static constexpr float CLIP_LEVEL = 0.999f; // ~0 dBFS
+  static constexpr float LED_SIZE = 8.0f;
+  static constexpr float VALUE_WIDTH = 48.0f;
+  static constexpr float BUTTON_WIDTH = 16.0f;
+  static constexpr int RECTS_PER_ROW = 9;
+
+  static constexpr ImU32 COLOR_BACKGROUND = IM_COL32(40, 40, 40, 255);
+  static constexpr ImU32 COLOR_GREEN = IM_COL32(0, 220, 0, 255);
+  static constexpr ImU32 COLOR_YELLOW = IM_COL32(230, 230, 0, 255);
+  static constexpr ImU32 COLOR_RED = IM_COL32(240, 0, 0, 255);
+  static constexpr ImU32 COLOR_RMS = IM_COL32(255, 255, 255, 160);
+  static constexpr ImU32 COLOR_PEAK = IM_COL32(255, 255, 255, 255);
+  static constexpr ImU32 COLOR_CLIP = IM_COL32(255, 0, 0, 255);
+  static constexpr ImU32 COLOR_LED_OFF = IM_COL32(70, 20, 20, 255);
+  static constexpr ImU32 COLOR_BUTTON = IM_COL32(77, 77, 77, 255);
+  static constexpr ImU32 COLOR_MUTE = IM_COL32(204, 51, 51, 255);
+  static constexpr ImU32 COLOR_SOLO = IM_COL32(230, 204, 26, 255);
+  static constexpr ImU32 COLOR_TEXT = IM_COL32(255, 255, 255, 255);
+  static constexpr ImU32 COLOR_DIM = IM_COL32(150, 150, 150, 255);
+  static constexpr ImU32 COLOR_REDUCTION = IM_COL32(255, 128, 0, 255);
+
+  std::vector<float> levelToPixel;   // SCALE_STEPS entries, see pixelFor()
+  std::vector<float> clipRemaining;  // Seconds each clip LED stays lit
+
+  // Per-row text, reformatted only when its value changes
+  struct readout {
+    char label[16] = "";
+    char peakText[16] = " -inf";
+    char rmsText[16] = " -inf";
+    char truePeakText[16] = " -inf";
+    float peak = 0.0f;  // Values the texts show
+    float rms = 0.0f;
+    float truePeakDb = -INFINITY;
+  };
+  std::vector<readout> readouts;
+  float greenEnd = 0.0f;             // Pixel where yellow starts (-30 dB)
+  float yellowEnd = 0.0f;            // Pixel where red starts (-9 dB)
+
+  // IEC 60268-18 deflection (0..1) for a level in dB
+  static float iecScale(float db) {
+    float def;
+    if (db < -70.0f) def = 0.0f;
+    else if (db < -60.0f) def = (db + 70.0f) * 0.25f;
+    else if (db < -50.0f) def = (db + 60.0f) * 0.5f + 2.5f;
+    else if (db < -40.0f) def = (db + 50.0f) * 0.75f + 7.5f;
+    else if (db < -30.0f) def = (db + 40.0f) * 1.5f + 15.0f;
+    else if (db < -20.0f) def = (db + 30.0f) * 2.0f + 30.0f;
+    else if (db < 0.0f) def = (db + 20.0f) * 2.5f + 50.0f;
+    else def = 100.0f;
+    return def / 100.0f;
+  }
+
+  static uint32_t levelBits(float linear) {
+    uint32_t bits;
+    std::memcpy(&bits, &linear, sizeof(bits));
+    return bits;
+  }
+
+  // Entry i covers the levels whose float bits, shifted down to exponent +
+  // SCALE_MANTISSA_BITS, equal i above 2^-SCALE_OCTAVES; each is placed at
+  // the level in the middle of its step
+  void buildScale() {
+    levelToPixel.resize(SCALE_STEPS);
+    for (int i = 0; i < SCALE_STEPS; i++) {
+      double level = std::ldexp(1.0 + (i % (1 << SCALE_MANTISSA_BITS) + 0.5) / (1 << SCALE_MANTISSA_BITS),
+                                i / (1 << SCALE_MANTISSA_BITS) - SCALE_OCTAVES);
+      levelToPixel[i] = iecScale((float)(20.0 * std::log10(level))) * barWidth;
+    }
+    greenEnd = iecScale(-30.0f) * barWidth;
+    yellowEnd = iecScale(-9.0f) * barWidth;
+  }
+
+  float pixelFor(float linear) const {
+    static const uint32_t floorBits = levelBits(std::ldexp(1.0f, -SCALE_OCTAVES));
+    if (!(linear > 0.0f)) return 0.0f;  // Also NaN
+    if (linear >= 1.0f) return barWidth;
+    uint32_t bits = levelBits(linear);
+    if (bits < floorBits) return 0.0f;
+    return levelToPixel[(bits - floorBits) >> (23 - SCALE_MANTISSA_BITS)];
+  }
+
+  static void formatDb(char* text, size_t size, float db) {
+    if (db > -60.0f) {
+      snprintf(text, size, "%5.1f", db);
+    } else {
+      snprintf(text, size, " -inf");
+    }
+  }
+};
+
+#endif // METER_RENDERER_HPP
@@ -0,0 +1,254 @@
+/*
+  Offline render: the player's onSound chain to a multichannel file
+
+  Runs player_core::onSound (routing, gains, room correction, EQ, bass
+  management, limiter) on a standalone AudioIOData as fast as the disks
+  allow, and writes every output channel to a WAV / BW64 file
+  (bw64Writer.hpp). Three threads form the pipeline:
+    stream reader  the player's prefetch reader (streamReader.hpp)
+    render         the calling thread: onSound, then interleave the block
+                   into a ring slot
+    file writer    drains the ring into the file (format conversion, stdio)
+  A block the stream has not buffered yet is not written: the render thread
+  waits briefly and calls onSound again at the same playhead, so the file
+  never contains the silence a real-time underrun would play.
+
+  Room correction runs without its real-time deadline (every channel's
+  job is waited for), so the file never holds a block played dry; should
+  any channel block still miss, the render fails.
+
+  The file lines up sample for sample with the source: the master gain and
+  bass management start at their settings instead of gliding to them, the
+  limiter's lookahead delay is dropped from the front, and past the end of
+  the source silence keeps going through the chain (player_core::flushTail)
+  until the correction filter / EQ tails have come out and the outputs are
+  quiet.
+*/
+
+#ifndef OFFLINE_RENDER_HPP
+#define OFFLINE_RENDER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bw64Writer.hpp"
+#include "playerCore.hpp"
+#include "traceRecorder.hpp"
+
+struct offline_renderer {
+  bw64_writer::Format format = bw64_writer::FLOAT32;
+  int queueBlocks = 64;  // Ring between render and writer threads
+  float tailSilence = 1e-6f;     // Output peak that ends the tail (-120 dBFS)
+  float maxTailSeconds = 10.0f;
+
+  // Results of the last run()
+  uint64_t framesRendered = 0;
+  uint64_t tailFrames = 0;   // Of framesRendered, past the end of the source
+  uint64_t diskWaits = 0;    // Blocks the stream had not buffered yet
+  uint64_t writerWaits = 0;  // Blocks the render thread waited for a free slot
+  double wallSeconds = 0.0;
+
+  // Render the player's loaded file from the top; stopRequested ends early
+  // (the file is still closed properly)
+  bool run(player_core& player, const std::string& path, const std::atomic<bool>* stopRequested = nullptr) {
+    using clock = std::chrono::steady_clock;
+    TRACE_THREAD("render");
+    if (!player.soundFile.opened()) {
+      std::cerr << "✗ ERROR: No audio file loaded, nothing to render" << std::endl;
+      return false;
+    }
+    channels = player.expectedChannels;
+    blockSize = player.audioBlockSize;
+    if (player.soundFile.frameRate() != player.audioSampleRate) {
+      if (player.matchFileRate) {
+        player.setSampleRate(player.soundFile.frameRate());  // No device to reopen: just the DSP
+      } else {
+        std::cerr << "⚠ WARNING: File is " << player.soundFile.frameRate() << " Hz, rendering at "
+                  << player.audioSampleRate << " Hz without resampling" << std::endl;
+      }
+    }
+    if (!writer.open(path, channels, player.audioSampleRate, format)) return false;
+
+    slots = (uint64_t)std::max(2, queueBlocks);
+    ringData.assign((size_t)slots * blockSize * channels, 0.0f);
+    slotFrames.assign(slots, 0);
+    writeIndex.store(0);
+    readIndex.store(0);
+    finished.store(false);
+    writeFailed.store(false);
+    framesRendered = tailFrames = diskWaits = writerWaits = 0;
+    std::thread fileWriter([this] { writerLoop(); });
+
+    // Once through the file, from the top, without the real-time warnings
+    player.stream.logWarnings = false;
+    player.stream.logSeconds = 0.0f;
+    player.loop = false;
+    player.frameCounter = 0;
+    player.playing = true;
+    player.flushTail = false;
+    player.outputGains.jumpToTargets(player.gain);
+    player.bassManagement.jumpToTargets();
+    latencySkip = player.limiter.enabled.load() ? (uint64_t)player.limiter.latencyFrames() : 0;
+    bool convolutionRealTime = player.convolution.realTime;
+    player.convolution.realTime = false;
+    uint64_t missesBefore = player.convolution.deadlineMisses.load();
+
+    AudioIOData io;
+    io.channelsOut(channels);
+    io.framesPerBuffer(blockSize);
+    io.framesPerSecond(player.audioSampleRate);
+
+    uint64_t totalFrames = (uint64_t)player.soundFile.frames();
+    int nextProgress = 10;
+    clock::time_point start = clock::now();
+    std::cout << "Rendering " << totalFrames / player.audioSampleRate << " s, " << channels << " channels to "
+              << path << std::endl;
+
+    while (player.playing && player.frameCounter < totalFrames && !writeFailed.load(std::memory_order_relaxed)) {
+      if (stopRequested && stopRequested->load()) {
+        std::cerr << "⚠ WARNING: Render stopped early, file is incomplete" << std::endl;
+        break;
+      }
+      uint64_t before = player.frameCounter;
+      io.frame(0);
+      player.onSound(io);
+      int advanced = (int)(player.frameCounter - before);
+      if (advanced <= 0) {
+        if (player.playing) {
+          diskWaits++;
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        continue;
+      }
+
+      // The whole block: past the end of the source it is already tail
+      queueBlock(io, blockSize);
+
+      int percent = totalFrames > 0 ? (int)(player.frameCounter * 100 / totalFrames) : 100;
+      if (percent >= nextProgress) {
+        std::cout << "  " << percent << "%" << std::endl;
+        nextProgress = percent / 10 * 10 + 10;
+      }
+    }
+
+    // Flush: at least the longest correction filter past the end of the
+    // source, then on until the outputs are silent
+    uint64_t minFrames = totalFrames + (player.convolution.enabled.load() ? (uint64_t)player.convolution.tailFrames() : 0);
+    uint64_t maxFrames = totalFrames + (uint64_t)(maxTailSeconds * player.audioSampleRate);
+    bool complete = player.frameCounter >= totalFrames;
+    player.flushTail = true;
+    while (complete && framesRendered < maxFrames && !writeFailed.load(std::memory_order_relaxed)) {
+      if (stopRequested && stopRequested->load()) break;
+      io.frame(0);
+      player.onSound(io);
+      if (framesRendered >= minFrames && outputPeak(io) < tailSilence) break;
+      queueBlock(io, blockSize);
+    }
+    player.flushTail = false;
+    player.convolution.realTime = convolutionRealTime;
+    tailFrames = framesRendered > totalFrames ? framesRendered - totalFrames : 0;
+    player.playing = false;
+    uint64_t correctionMisses = player.convolution.deadlineMisses.load() - missesBefore;
+
+    finished.store(true, std::memory_order_release);
+    fileWriter.join();
+    bool ok = writer.close() && !writeFailed.load();
+    if (correctionMisses > 0) {
+      std::cerr << "✗ ERROR: Room correction missing from " << correctionMisses
+                << " channel blocks of the render: " << path << " is not usable" << std::endl;
+      ok = false;
+    }
+    wallSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    double audioSeconds = framesRendered / player.audioSampleRate;
+    if (ok) {
+      std::cout << "✓ Rendered " << std::fixed << std::setprecision(2) << audioSeconds << " s (" << framesRendered
+                << " frames, " << tailFrames / player.audioSampleRate << " s of it tail) to " << path << " in "
+                << wallSeconds << " s ("
+                << std::setprecision(1) << (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0) << "x real time)"
+                << std::defaultfloat << std::endl;
+      std::cout << "  Waited on disk: " << diskWaits << " blocks, writer queue full: " << writerWaits << " blocks"
+                << std::endl;
+    } else {
+      std::cerr << "✗ ERROR: Render failed: " << path << std::endl;
+    }
+    return ok;
+  }
+
+private:
+  bw64_writer writer;
+  int channels = 0;
+  int blockSize = 0;
+  uint64_t slots = 0;
+  std::vector<float> ringData;  // slots x blockSize x channels, interleaved
+  std::vector<int> slotFrames;
+  std::atomic<uint64_t> writeIndex{0};  // Render thread
+  std::atomic<uint64_t> readIndex{0};   // Writer thread
+  std::atomic<bool> finished{false};
+  std::atomic<bool> writeFailed{false};
+
+  uint64_t latencySkip = 0;  // Lookahead frames still to drop from the front
+
+  float* slotData(uint64_t s) { return &ringData[(size_t)s * blockSize * channels]; }
+
+  // Interleave a rendered block into the next ring slot, minus any lookahead
+  // still to drop (waits for the writer to free a slot)
+  void queueBlock(const AudioIOData& io, int frames) {
+    int from = (int)std::min<uint64_t>(latencySkip, frames);
+    latencySkip -= from;
+    if (from == frames) return;
+    uint64_t w = writeIndex.load(std::memory_order_relaxed);
+    if (w - readIndex.load(std::memory_order_acquire) >= slots) {
+      writerWaits++;
+      while (w - readIndex.load(std::memory_order_acquire) >= slots && !writeFailed.load()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+      }
+    }
+    float* slot = slotData(w % slots);
+    for (int ch = 0; ch < channels; ch++) {
+      const float* out = io.outBuffer(ch) + from;
+      for (int f = 0; f < frames - from; f++) slot[(size_t)f * channels + ch] = out[f];
+    }
+    slotFrames[w % slots] = frames - from;
+    writeIndex.store(w + 1, std::memory_order_release);
+    framesRendered += frames - from;
+  }
+
+  float outputPeak(const AudioIOData& io) const {
+    float peak = 0.0f;
+    for (int ch = 0; ch < channels; ch++) {
+      const float* out = io.outBuffer(ch);
+      for (int f = 0; f < blockSize; f++) peak = std::max(peak, std::fabs(out[f]));
+    }
+    return peak;
+  }
+
+  void writerLoop() {
+    TRACE_THREAD("file writer");
+    for (;;) {
+      uint64_t r = readIndex.load(std::memory_order_relaxed);
+      if (r == writeIndex.load(std::memory_order_acquire)) {
+        if (finished.load(std::memory_order_acquire) && r == writeIndex.load(std::memory_order_acquire)) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+      {
+        TRACE_SCOPE("file write");
+        if (!writer.write(slotData(r % slots), slotFrames[r % slots])) {
+          writeFailed.store(true);
+          return;
+        }
+      }
+      readIndex.store(r + 1, std::memory_order_release);
+    }
+  }
+};
+
+#endif // OFFLINE_RENDER_HPP
@@ -0,0 +1,129 @@
+/*
+  Per-output gain: trim, mute / solo and smoothed master gain
+
+  The GUI edits trims and mute/solo flags and calls commit(), which folds
+  them into one target gain per output and publishes it lock-free (triple
+  buffer). Each block the audio thread multiplies the targets by the master
+  gain and ramps every output from the gain it ended the last block on to
+  its new target over the block (linear or exponential shape), so slider
+  moves and mutes never zipper or click.
+
+  route() applies the ramp while copying a file channel into its output
+  buffer and measures the block peak / sum of squares, so gain and
+  metering cost no extra pass over the outputs.
+*/
+
+#ifndef OUTPUT_GAINS_HPP
+#define OUTPUT_GAINS_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "meterKernel.hpp"
+#include "tripleBuffer.hpp"
+
+struct output_gains {
+  enum Ramp { LINEAR, EXPONENTIAL };
+  int rampMode = LINEAR;
+
+  // GUI-thread settings; call commit() after changing them
+  std::vector<float> trimDb;
+  std::vector<uint8_t> mute;
+  std::vector<uint8_t> solo;
+
+  void prepare(int numOutputs, int maxFrames) {
+    outputs = numOutputs;
+    trimDb.assign(outputs, 0.0f);
+    mute.assign(outputs, 0);
+    solo.assign(outputs, 0);
+    targets.init([this](std::vector<float>& t) { t.assign(outputs, 1.0f); });
+    current.assign(outputs, 0.0f);  // Fade in on the first block
+    start.assign(outputs, 0.0f);
+    rampShape.assign(maxFrames, 1.0f);
+    shapeFrames = -1;
+    commit();
+  }
+
+  bool anySolo() const {
+    for (uint8_t s : solo) {
+      if (s) return true;
+    }
+    return false;
+  }
+
+  // GUI thread: combine trim and mute/solo into per-output targets
+  void commit() {
+    bool soloing = anySolo();
+    std::vector<float>& t = targets.writeBuffer();
+    for (int ch = 0; ch < outputs; ch++) {
+      bool audible = !mute[ch] && (!soloing || solo[ch]);
+      t[ch] = audible ? std::pow(10.0f, trimDb[ch] / 20.0f) : 0.0f;
+    }
+    targets.publish();
+  }
+
+  // Start the next block on the targets instead of ramping up to them
+  // (offline renders, where there is no click to avoid)
+  void jumpToTargets(float masterGain) {
+    targets.update();
+    const std::vector<float>& t = targets.readBuffer();
+    for (int ch = 0; ch < outputs; ch++) current[ch] = t[ch] * masterGain;
+  }
+
+  // Audio thread: latch new targets for a block of `frames`
+  void beginBlock(float masterGain, int frames) {
+    if (frames > (int)rampShape.size()) frames = (int)rampShape.size();
+    targets.update();
+    const std::vector<float>& t = targets.readBuffer();
+    for (int ch = 0; ch < outputs; ch++) {
+      start[ch] = current[ch];
+      current[ch] = t[ch] * masterGain;
+    }
+    blockFrames = frames;
+    updateShape(frames);
+  }
+
+  // Audio thread: dst[n] = src[n * stride] * ramped gain, measuring the
+  // block peak and sum of squares on the way
+  void route(int ch, const float* src, int stride, float* dst, int frames,
+             float& peak, float& sumSquares) const {
+    float g0 = start[ch];
+    float g1 = current[ch];
+    if (g0 == g1 || frames > blockFrames) {
+      copyGainMeasure(src, stride, dst, frames, g1, peak, sumSquares);
+    } else {
+      copyRampMeasure(src, stride, dst, frames, g0, g1 - g0, rampShape.data(), peak, sumSquares);
+    }
+  }
+
+private:
+  int outputs = 0;
+  triple_buffer<std::vector<float>> targets;  // GUI -> audio, trim x mute/solo
+  std::vector<float> current;                 // Gain each output ends the block on
+  std::vector<float> start;                   // Gain each output starts the block on
+  std::vector<float> rampShape;               // 0 -> 1 over the block
+  int blockFrames = 0;
+  int shapeFrames = -1;
+  int shapeMode = -1;
+
+  // One shared 0..1 ramp per block; recomputed only when size or mode changes
+  void updateShape(int frames) {
+    if (frames == shapeFrames && rampMode == shapeMode) return;
+    shapeFrames = frames;
+    shapeMode = rampMode;
+    if (rampMode == EXPONENTIAL) {
+      // One-pole approach normalized to land exactly on the target at block end
+      double r = std::pow(0.001, 1.0 / frames);
+      double norm = 1.0 / (1.0 - std::pow(r, frames));
+      double decay = 1.0;
+      for (int n = 0; n < frames; n++) {
+        decay *= r;
+        rampShape[n] = (float)((1.0 - decay) * norm);
+      }
+    } else {
+      for (int n = 0; n < frames; n++) rampShape[n] = (float)(n + 1) / (float)frames;
+    }
+  }
+};
+
+#endif // OUTPUT_GAINS_HPP
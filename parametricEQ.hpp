@@ -0,0 +1,142 @@
+/*
+  Parametric EQ per speaker and per ring
+
+  Every output gets two groups of EQ_BANDS biquads:
+  - ring bands, shared by all speakers of its ring (upper, middle, lower,
+    sub; see ChannelMapping::getRing) - e.g. tilt the upper ring
+  - speaker bands, for that output only - e.g. notch one resonance
+
+  All outputs run as one channel-parallel biquad bank (see biquadBank.hpp).
+
+  Band settings live on the GUI thread. commit() designs a complete
+  coefficient set and publishes it through a lock-free triple buffer; the
+  audio thread picks it up at the start of a block and interpolates from
+  the current coefficients to the new ones over one block, so dragging a
+  band never clicks.
+*/
+
+#ifndef PARAMETRIC_EQ_HPP
+#define PARAMETRIC_EQ_HPP
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include "biquadBank.hpp"
+#include "channelMapping.hpp"
+#include "tripleBuffer.hpp"
+
+constexpr int EQ_BANDS = 4;  // Bands per group (ring / speaker)
+
+struct eq_band {
+  enum Type { PEAK, LOW_SHELF, HIGH_SHELF, HIGH_PASS, LOW_PASS, NUM_TYPES };
+
+  bool enabled = false;
+  int type = PEAK;
+  float freq = 1000.0f;
+  float gainDb = 0.0f;
+  float q = 0.707f;
+
+  biquad_coeffs design(double sampleRate) const {
+    if (!enabled) return biquad_coeffs();
+    switch (type) {
+      case LOW_SHELF: return biquad_coeffs::lowShelf(freq, q, gainDb, sampleRate);
+      case HIGH_SHELF: return biquad_coeffs::highShelf(freq, q, gainDb, sampleRate);
+      case HIGH_PASS: return biquad_coeffs::highpass(freq, q, sampleRate);
+      case LOW_PASS: return biquad_coeffs::lowpass(freq, q, sampleRate);
+      default: return biquad_coeffs::peaking(freq, q, gainDb, sampleRate);
+    }
+  }
+};
+
+constexpr const char* EQ_BAND_TYPE_NAMES[eq_band::NUM_TYPES] = {
+    "Peak", "Low Shelf", "High Shelf", "High Pass", "Low Pass"};
+
+using eq_band_set = std::array<eq_band, EQ_BANDS>;
+
+struct parametric_eq_bank {
+  std::atomic<bool> enabled{false};  // Written by the GUI, read by the audio thread
+
+  // GUI-thread settings; call commit() after changing them
+  std::array<eq_band_set, ChannelMapping::NUM_RINGS> ringBands;
+  std::vector<eq_band_set> speakerBands;  // One set per lane
+
+  void prepare(int numLanes, int maxFrames, double sampleRate) {
+    lanes = numLanes;
+    rate = sampleRate;
+    rampLength = maxFrames;
+    speakerBands.assign(lanes, eq_band_set());
+    bank.init(lanes, 2 * EQ_BANDS);
+    rampFrom.init(lanes * 2 * EQ_BANDS);
+    published.init([this](biquad_coeff_set& set) { set.init(lanes * 2 * EQ_BANDS); });
+    ramping = false;
+  }
+
+  // GUI thread: design coefficients for every output and hand them to audio
+  void commit() {
+    biquad_coeff_set& set = published.writeBuffer();
+    for (int lane = 0; lane < lanes; lane++) {
+      ChannelMapping::Ring ring = ChannelMapping::getRing(lane);
+      for (int b = 0; b < EQ_BANDS; b++) {
+        biquad_coeffs ringCoeffs;
+        if (ring != ChannelMapping::Ring::None) {
+          ringCoeffs = ringBands[static_cast<int>(ring)][b].design(rate);
+        }
+        set.set(b * lanes + lane, ringCoeffs);
+        set.set((EQ_BANDS + b) * lanes + lane, speakerBands[lane][b].design(rate));
+      }
+    }
+    published.publish();
+  }
+
+  // Audio thread: EQ a frame-major block (frames x lanes) in place
+  void process(float* block, int frames) {
+    if (!enabled.load(std::memory_order_relaxed) || lanes == 0) {
+      wasEnabled = false;
+      return;
+    }
+    if (!wasEnabled) {
+      bank.reset();
+      wasEnabled = true;
+    }
+
+    // New settings: ramp from wherever the coefficients are right now
+    if (published.update()) {
+      rampFrom.copy(bank.coeffs);
+      rampPosition = 0;
+      ramping = true;
+    }
+
+    if (!ramping) {
+      bank.process(block, frames);
+      return;
+    }
+
+    // Step the interpolation every RAMP_STEP frames over one block
+    const biquad_coeff_set& target = published.readBuffer();
+    for (int offset = 0; offset < frames; offset += RAMP_STEP) {
+      int count = frames - offset < RAMP_STEP ? frames - offset : RAMP_STEP;
+      if (ramping) {
+        rampPosition += count;
+        float t = rampPosition >= rampLength ? 1.0f : (float)rampPosition / (float)rampLength;
+        bank.coeffs.interpolate(rampFrom, target, t);
+        ramping = t < 1.0f;
+      }
+      bank.process(block + (size_t)offset * lanes, count);
+    }
+  }
+
+private:
+  static constexpr int RAMP_STEP = 16;
+
+  int lanes = 0;
+  double rate = 48000.0;
+  biquad_bank bank;                          // lanes x (ring bands + speaker bands)
+  triple_buffer<biquad_coeff_set> published;  // GUI -> audio coefficient hand-off
+  biquad_coeff_set rampFrom;
+  int rampLength = 512;
+  int rampPosition = 0;
+  bool ramping = false;
+  bool wasEnabled = false;
+};
+
+#endif // PARAMETRIC_EQ_HPP
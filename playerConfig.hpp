@@ -0,0 +1,138 @@
+/*
+  Player settings from a config file and the command line
+
+  Config file: one `key = value` per line, `#` starts a comment. Command-line
+  options use the same keys (`--samplerate 96000`) and override the file;
+  `--config FILE` names the file. Flags given to parse() (`--play`) stand
+  for `key = on`.
+
+  Audio device keys, shared by mainplayer and headlessplayer: readDevice()
+  checks them into a device_settings, which player_core::applyDevice() takes
+  before onInit():
+    samplerate  Device sample rate in Hz (default 48000)
+    blocksize   Device buffer size in frames (default 512)
+    outputs     Output channels (default 60)
+    inputs      Input channels (default 0; live input needs them)
+    matchrate   on / off: reopen the device at each file's sample rate
+                (default on; off plays other rates at the wrong speed)
+*/
+
+#ifndef PLAYER_CONFIG_HPP
+#define PLAYER_CONFIG_HPP
+
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <string>
+
+inline bool isTrue(const std::string& value) {
+  return value == "1" || value == "on" || value == "true" || value == "yes";
+}
+
+inline std::string trim(const std::string& s) {
+  size_t first = s.find_first_not_of(" \t\r");
+  if (first == std::string::npos) return "";
+  size_t last = s.find_last_not_of(" \t\r");
+  return s.substr(first, last - first + 1);
+}
+
+// Audio device settings as plain values (defaults: the player's, see
+// player_core::deviceSettings())
+struct device_settings {
+  double sampleRate = 48000.0;
+  int blockSize = 512;
+  int outputs = 60;
+  int inputs = 0;
+  bool matchRate = true;
+};
+
+struct player_config {
+  std::map<std::string, std::string> settings;
+
+  // Command line, then the config file it names (command line wins). False
+  // on an unexpected argument or an unreadable config file.
+  bool parse(int argc, char* argv[], std::initializer_list<const char*> flags = {}) {
+    std::string configPath;
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      bool flag = false;
+      for (const char* f : flags) flag = flag || arg == std::string("--") + f;
+      if (flag) {
+        settings[arg.substr(2)] = "on";
+        continue;
+      }
+      if (arg.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+        std::cerr << "✗ ERROR: Unexpected argument: " << arg << std::endl;
+        return false;
+      }
+      std::string key = arg.substr(2);
+      if (key == "config") {
+        configPath = argv[++i];
+      } else {
+        settings[key] = argv[++i];
+      }
+    }
+    return configPath.empty() || readFile(configPath);
+  }
+
+  // key = value lines into settings (existing keys are kept: command line wins)
+  bool readFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+      std::cerr << "✗ ERROR: Could not open config file: " << path << std::endl;
+      return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+      lineNumber++;
+      line = trim(line.substr(0, line.find('#')));
+      if (line.empty()) continue;
+      size_t equals = line.find('=');
+      if (equals == std::string::npos) {
+        std::cerr << "⚠ WARNING: " << path << ":" << lineNumber << ": expected key = value" << std::endl;
+        continue;
+      }
+      settings.emplace(trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+    }
+    return true;
+  }
+
+  std::string get(const std::string& key, const std::string& fallback) const {
+    auto found = settings.find(key);
+    return found != settings.end() ? found->second : fallback;
+  }
+
+  // Device keys over the values already in device; false (device unchanged)
+  // if one is out of range
+  bool readDevice(device_settings& device) const {
+    double rate = std::atof(get("samplerate", std::to_string(device.sampleRate)).c_str());
+    int block = std::atoi(get("blocksize", std::to_string(device.blockSize)).c_str());
+    int outputs = std::atoi(get("outputs", std::to_string(device.outputs)).c_str());
+    int inputs = std::atoi(get("inputs", std::to_string(device.inputs)).c_str());
+    bool ok = true;
+    if (rate < 8000.0 || rate > 384000.0) {
+      std::cerr << "✗ ERROR: samplerate must be 8000 - 384000 Hz, not " << get("samplerate", "") << std::endl;
+      ok = false;
+    }
+    if (block < 16 || block > 8192) {
+      std::cerr << "✗ ERROR: blocksize must be 16 - 8192 frames, not " << get("blocksize", "") << std::endl;
+      ok = false;
+    }
+    if (outputs < 1 || outputs > 256 || inputs < 0 || inputs > 256) {
+      std::cerr << "✗ ERROR: outputs must be 1 - 256 and inputs 0 - 256" << std::endl;
+      ok = false;
+    }
+    if (!ok) return false;
+    device.sampleRate = rate;
+    device.blockSize = block;
+    device.outputs = outputs;
+    device.inputs = inputs;
+    device.matchRate = isTrue(get("matchrate", device.matchRate ? "on" : "off"));
+    return true;
+  }
+};
+
+#endif // PLAYER_CONFIG_HPP
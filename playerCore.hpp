@@ -0,0 +1,675 @@
+/*
+  Player audio core: everything between the file / inputs and the outputs
+
+  File loading and streaming, the channel routing and gains, room
+  correction, EQ, bass management, limiter, metering hand-off, analysis
+  taps, recording and the audio callback (onSound). No window, GL or ImGui:
+  the headless player, offline render, routing check and benchmarks build
+  on this alone; the GUI player (mainplayer.hpp) derives from it and adds
+  the controls, meters and dome view.
+*/
+
+#ifndef PLAYER_CORE_HPP
+#define PLAYER_CORE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "al/io/al_AudioIO.hpp"
+#include "al/io/al_File.hpp"
+#include "Gamma/SoundFile.h"
+#include "audioTap.hpp"
+#include "bassManager.hpp"
+#include "blockRecorder.hpp"
+#include "callbackTimer.hpp"
+#include "channelMapping.hpp"
+#include "convolutionEngine.hpp"
+#include "limiterBank.hpp"
+#include "loudnessMeter.hpp"
+#include "meterBus.hpp"
+#include "meterKernel.hpp"
+#include "outputGains.hpp"
+#include "parametricEQ.hpp"
+#include "playerConfig.hpp"
+#include "rtLog.hpp"
+#include "spectrumAnalyzer.hpp"
+#include "streamReader.hpp"
+#include "traceRecorder.hpp"
+
+using namespace al;
+
+struct player_core {
+  gam::SoundFile soundFile;
+  uint64_t frameCounter = 0;
+  std::vector<float> buffer;
+
+  // Playback controls
+  bool playing = false;
+  bool loop = true;
+  float gain = 0.5f;
+  bool streamingMode = true;  // Enable streaming for large files
+  stream_reader stream;  // Background prefetch reader (streaming mode)
+  std::string loadedPath;  // File open in soundFile (reopened by setStreamingMode)
+
+  // Handover: a load, mode switch or correction reload parks onSound (it
+  // plays silence) and waits out a callback in progress before it touches
+  // soundFile, stream, buffer, numChannels, frameCounter or the correction
+  // filters. Dekker-style:
+  // each side stores its flag, then reads the other's (both seq_cst).
+  std::atomic<bool> fileParked{false};       // Control thread
+  std::atomic<uint64_t> callbackEdges{0};    // Audio thread: +1 on entry and exit (odd = inside)
+
+  // Audio file info
+  int numChannels = 56; //default 
+  int expectedChannels = 60; //default
+  std::string audioFolder;
+  // std::string audioFolder = "../adm-allo-player/sourceAudio/";
+  //std::string audioFileName = "1-swale-allo-render.wav";
+  // selection is done via audioFiles + selectedFileIndex (no single audioFileName string)
+
+  // Audio device settings (must match configureAudio() in main; see
+  // applyDevice() and playerConfig.hpp for the config file / command-line keys)
+  double audioSampleRate = 48000.0;
+  int audioBlockSize = 512;
+  int inputChannels = 0;  // Hardware inputs to open (live input needs them)
+  bool matchFileRate = true;       // Reopen the device at each file's sample rate
+  double pendingSampleRate = 0.0;  // Rate the last file load asked for (0 = none), see applyPendingRate()
+  float safeLoad = 0.75f;          // 99.9th-percentile DSP load above which checkLatency() warns
+  bool latencyWarned = false;
+
+  // Live input: hardware input N takes the place of file channel N, through
+  // the same map, gains and DSP chain (the file transport is bypassed)
+  std::atomic<bool> liveInput{false};  // Written by the GUI / control socket
+  bool blockSizeWarned = false;  // Audio thread: larger-than-configured block logged
+
+  // Offline render past the end of the file: silence goes through the chain
+  // so the limiter lookahead and filter tails come out (playhead holds)
+  bool flushTail = false;
+
+  // Metering: onSound publishes raw block peak / sum of squares lock-free
+  // for a display to read (see meterBus.hpp)
+  meter_bus meters;
+  std::vector<float> blockPeak;        // Audio-thread scratch, per output
+  std::vector<float> blockSumSquares;  // Audio-thread scratch, per output
+
+  // onSound stage timing, DSP load, duration histogram, late / underrun counts
+  callback_timer callbackTiming;
+
+  // Set (any thread, the audio thread included) when a load, rate change or
+  // end of file changes what a display shows; a GUI clears it
+  std::atomic<bool> stateChanged{false};
+
+  // Output recording: onSound -> ring -> writer thread -> WAV / BW64
+  block_recorder recorder;
+
+  // Analysis consumers read the final output blocks off the audio thread
+  // (declared before its consumers so they stop first)
+  audio_tap outputTap;
+
+  // EBU R128 loudness + true peak, analyzed on a worker thread (see loudnessMeter.hpp)
+  loudness_meter loudness;
+
+  // FFT spectrum of selected outputs, analyzed on a worker thread
+  spectrum_analyzer spectrum;
+
+  // Routing and per-output gain (trim, mute/solo, ramped master gain)
+  std::vector<int> outputSource;  // File channel feeding each output (-1 = none)
+  output_gains outputGains;
+
+  // Room correction (partitioned FFT convolution per output)
+  convolution_engine convolution;
+  std::string correctionFilterFile;  // Multichannel FIR WAV, channel N -> output N (empty = off)
+
+  // Channel-parallel DSP (runs on a frame-major copy of the output block)
+  parametric_eq_bank eq;
+  bass_manager bassManagement;
+  limiter_bank limiter;           // Speaker protection, last stage before the outputs
+  std::vector<float> frameBlock;  // audioBlockSize x outputLanes
+  int outputLanes = 0;            // expectedChannels padded to SIMD width
+
+  // File selection
+  std::vector<std::string> audioFiles;  // List of available audio files
+  int selectedFileIndex = 0;            // Currently selected file index
+  std::string initialFile;              // File to open on init (empty = first)
+
+  device_settings deviceSettings() const {
+    device_settings device;
+    device.sampleRate = audioSampleRate;
+    device.blockSize = audioBlockSize;
+    device.outputs = expectedChannels;
+    device.inputs = inputChannels;
+    device.matchRate = matchFileRate;
+    return device;
+  }
+
+  // Device settings from the config (before onInit)
+  void applyDevice(const device_settings& device) {
+    int mappedOutputs = 0;
+    for (const auto& mapping : ChannelMapping::channelMap) mappedOutputs = std::max(mappedOutputs, mapping.second + 1);
+    if (device.outputs < mappedOutputs) {
+      std::cerr << "⚠ WARNING: " << device.outputs << " outputs, the channel map uses " << mappedOutputs
+                << ": the outputs past " << device.outputs << " are not played" << std::endl;
+    }
+    audioSampleRate = device.sampleRate;
+    audioBlockSize = device.blockSize;
+    expectedChannels = device.outputs;
+    inputChannels = device.inputs;
+    matchFileRate = device.matchRate;
+  }
+
+  void setSourceAudioFolder(const std::string& folder) {
+    audioFolder = folder;
+  }
+
+  void setCorrectionFilterFile(const std::string& path) {
+    correctionFilterFile = path;
+  }
+
+  void setInitialFile(const std::string& filename) {
+    initialFile = filename;
+  }
+  void scanAudioFiles() {
+    audioFiles.clear();
+    std::string audioDir = al::File::currentPath() + audioFolder;
+
+    std::cout << "Scanning for audio files in: " << audioDir << std::endl;
+
+    try {
+      // Use al::filterInDir to find .wav files
+      al::FileList wavFiles = al::filterInDir(audioDir, [](const al::FilePath& fp) {
+        return al::checkExtension(fp, ".wav");
+      }, false); // false = not recursive
+
+      // Convert FileList to vector of strings
+      for (auto& fp : wavFiles) {
+        audioFiles.push_back(fp.file());
+      }
+
+      // Make ordering deterministic: lexicographic sort (case-sensitive, std::string <)
+      std::sort(audioFiles.begin(), audioFiles.end());
+    } catch (const std::exception& e) {
+      std::cerr << "Error scanning audio directory: " << e.what() << std::endl;
+    }
+
+    std::cout << "Found " << audioFiles.size() << " audio files" << std::endl;
+  }
+
+  // Holds the file state away from the audio thread while in scope
+  struct parked_file {
+    player_core& player;
+    explicit parked_file(player_core& p) : player(p) {
+      player.fileParked.store(true);
+      uint64_t edges = player.callbackEdges.load();
+      if (edges & 1) {
+        while (player.callbackEdges.load() == edges) std::this_thread::yield();
+      }
+    }
+    ~parked_file() { player.fileParked.store(false, std::memory_order_release); }
+  };
+
+  // Load a new audio file (any thread; audio may be running)
+  bool loadAudioFile(const std::string& filename) {
+    TRACE_SCOPE("loadAudioFile");
+    std::string audioPath = al::File::currentPath() + audioFolder + filename;
+
+    std::cout << "\n=== Loading new audio file ===" << std::endl;
+    std::cout << "File: " << audioPath << std::endl;
+
+    // Stop playback during load
+    parked_file parked(*this);
+    bool wasPlaying = playing;
+    playing = false;
+    stream.close();
+    loadedPath.clear();
+
+    if (!soundFile.openRead(audioPath)) {
+      std::cerr << "✗ ERROR: Could not open file: " << audioPath << std::endl;
+      return false;
+    }
+    loadedPath = audioPath;
+
+    std::cout << "✓ Audio file loaded successfully" << std::endl;
+    std::cout << "  Sample rate: " << soundFile.frameRate() << " Hz" << std::endl;
+    std::cout << "  Channels: " << soundFile.channels() << std::endl;
+    std::cout << "  Frame count: " << soundFile.frames() << std::endl;
+    std::cout << "  Duration: " << (double)soundFile.frames() / soundFile.frameRate() << " seconds" << std::endl;
+    numChannels = soundFile.channels();
+
+    // Sample rate: ask the device owner to switch, or play it as is
+    pendingSampleRate = 0.0;
+    if (soundFile.frameRate() != audioSampleRate) {
+      if (matchFileRate) {
+        pendingSampleRate = soundFile.frameRate();
+        std::cout << "  Device runs at " << audioSampleRate << " Hz, switching to " << pendingSampleRate << " Hz"
+                  << std::endl;
+      } else {
+        std::cerr << "⚠ WARNING: File is " << soundFile.frameRate() << " Hz but the device runs at "
+                  << audioSampleRate << " Hz: it plays at the wrong speed and pitch" << std::endl;
+      }
+    }
+
+    // For streaming mode, we don't preload data - Gamma SoundFile doesn't load data by default
+    if (streamingMode) {
+      std::cout << "  Streaming mode enabled - data not loaded into memory" << std::endl;
+    }
+    // note: we don't store a single filename string; selection is tracked by audioFiles[selectedFileIndex]
+
+    if (numChannels != expectedChannels) {
+      std::cerr << "⚠ WARNING: Expected " << expectedChannels << " channels but file has "
+                << numChannels << " channels." << std::endl;
+    }
+
+    // For streaming mode, start the prefetch reader at the top of the file
+    if (streamingMode && !stream.open(audioPath)) {
+      return false;
+    }
+    // note: we don't store a single filename string; selection is tracked by audioFiles[selectedFileIndex]
+
+    if (numChannels != expectedChannels) {
+      std::cerr << "⚠ WARNING: Expected " << expectedChannels << " channels but file has "
+                << numChannels << " channels." << std::endl;
+    }
+
+    // Reset playback position
+    frameCounter = 0;
+
+    // Resize buffers for new channel count
+    buffer.resize(audioBlockSize * numChannels);
+
+    // Resume playback if was playing
+    playing = wasPlaying;
+    stateChanged.store(true);
+
+    return true;
+  }
+
+  // Switch between the prefetch reader and direct reads (audio may be
+  // running); the reader picks up at the current playhead
+  bool setStreamingMode(bool on) {
+    parked_file parked(*this);
+    stream.close();
+    streamingMode = on;
+    if (on && soundFile.opened() && !stream.open(loadedPath)) {
+      streamingMode = false;
+      std::cerr << "⚠ WARNING: Streaming unavailable, reading the file directly" << std::endl;
+    }
+    stateChanged.store(true);
+    return streamingMode == on;
+  }
+
+  void onInit()  {
+    rtLog();  // Start the log formatter here, not on the audio thread's first message
+    std::cout << "\n=== 54-Channel Audio Player ===" << std::endl;
+    std::cout << "Current path: " << al::File::currentPath() << std::endl;
+
+    // Enable streaming mode for large files
+    streamingMode = true; // should make this dynamically set able 
+    std::cout << "Streaming mode: ENABLED (for large file support)" << std::endl;
+
+    prepareAudio();
+
+    // populate audioFiles from folder and pick selectedFileIndex
+    scanAudioFiles();
+    if (audioFiles.empty()) {
+      std::cerr << "✗ ERROR: No audio files found in: " << al::File::currentPath() + audioFolder << std::endl;
+      std::cerr << "Please update the audioFolder or add files." << std::endl;
+      // quit();
+      return;
+    }
+    if (!initialFile.empty()) {
+      auto found = std::find(audioFiles.begin(), audioFiles.end(), initialFile);
+      if (found != audioFiles.end()) {
+        selectedFileIndex = static_cast<int>(found - audioFiles.begin());
+      } else {
+        std::cerr << "⚠ WARNING: " << initialFile << " not found, opening " << audioFiles[0] << std::endl;
+      }
+    }
+    if (selectedFileIndex < 0 || selectedFileIndex >= static_cast<int>(audioFiles.size())) selectedFileIndex = 0;
+
+    // Load the selected file (loadAudioFile prints details)
+    if (!loadAudioFile(audioFiles[selectedFileIndex])) {
+      std::cerr << "✗ ERROR: Could not open selected audio file." << std::endl;
+      // quit();
+      return;
+    }
+
+    // Ensure buffers sized (loadAudioFile already resizes but keep safe)
+    buffer.resize(audioBlockSize * numChannels);
+    frameCounter = 0;
+  }
+
+  // Everything that depends on the device settings (rate, block size,
+  // channels). Allocates and starts worker threads: call before audio
+  // starts.
+  void prepareAudio() {
+    // Invert the channel map once: which file channel feeds each output
+    outputSource.assign(expectedChannels, -1);
+    for (const auto& mapping : ChannelMapping::channelMap) {
+      if (mapping.second < expectedChannels) outputSource[mapping.second] = mapping.first;
+    }
+    outputGains.prepare(expectedChannels, audioBlockSize);
+
+    meters.prepare(expectedChannels);
+    blockPeak.assign(expectedChannels, 0.0f);
+    blockSumSquares.assign(expectedChannels, 0.0f);
+
+    outputLanes = paddedLanes(expectedChannels);
+    frameBlock.assign((size_t)audioBlockSize * outputLanes, 0.0f);
+    buffer.resize((size_t)audioBlockSize * numChannels);
+    prepareRateStages();
+  }
+
+  // The stages designed for the sample rate, again after a rate change
+  // (audio stopped). GUI settings (trims, EQ bands, spectrum selection,
+  // limiter / crossover) are kept; a recording in progress ends.
+  void prepareRateStages() {
+    loudness.stop();  // Off the tap before it is prepared again
+    spectrum.stop();
+
+    // Room correction filters are prepared before audio starts (allocates, spawns workers)
+    if (!correctionFilterFile.empty()) {
+      convolution.load(al::File::currentPath() + correctionFilterFile, expectedChannels,
+                       audioBlockSize, audioSampleRate);
+    }
+
+    // Loudness counts the dome speakers only (sub / unmapped outputs weigh 0)
+    std::vector<float> loudnessWeights(expectedChannels, 0.0f);
+    for (int ch = 0; ch < expectedChannels; ch++) {
+      ChannelMapping::Ring ring = ChannelMapping::getRing(ch);
+      bool speaker = ring != ChannelMapping::Ring::Sub && ring != ChannelMapping::Ring::None;
+      if (speaker && outputSource[ch] >= 0) loudnessWeights[ch] = 1.0f;
+    }
+    std::vector<uint8_t> spectrumSelection = spectrum.selected;
+    outputTap.prepare(expectedChannels, audioBlockSize);
+    recorder.prepare(expectedChannels, inputChannels, audioSampleRate);
+    loudness.prepare(outputTap, audioSampleRate, loudnessWeights);
+    spectrum.prepare(outputTap, audioSampleRate);
+    if (spectrumSelection.size() == spectrum.selected.size()) {
+      spectrum.selected = spectrumSelection;
+      spectrum.commit();
+    }
+
+    std::vector<eq_band_set> speakerBands = eq.speakerBands;
+    eq.prepare(outputLanes, audioBlockSize, audioSampleRate);
+    if (speakerBands.size() == eq.speakerBands.size()) eq.speakerBands = speakerBands;
+    eq.commit();
+    bassManagement.prepare(outputLanes, audioBlockSize, audioSampleRate);
+    limiter.prepare(outputLanes, audioSampleRate);
+
+    blockSizeWarned = false;
+    latencyWarned = false;
+    callbackTiming.requestReset();
+  }
+
+  // Run at another sample rate (audio stopped): prepares every
+  // rate-dependent stage again
+  void setSampleRate(double rate) {
+    pendingSampleRate = 0.0;
+    if (rate == audioSampleRate) return;
+    audioSampleRate = rate;
+    prepareRateStages();
+    stateChanged.store(true);
+  }
+
+  // Owner of the device (GUI loop / headless control loop): reopen it at
+  // the rate the last file load asked for. Playback carries on where it
+  // was. Returns false if the device refused the rate (it stays at the old
+  // one and the file plays at the wrong speed).
+  bool applyPendingRate(AudioIO& audio) {
+    if (pendingSampleRate <= 0.0) return true;
+    double rate = pendingSampleRate, previous = audioSampleRate;
+    bool wasPlaying = playing;
+    bool wasOpen = audio.isOpen(), wasRunning = audio.isRunning();
+    playing = false;
+    if (wasRunning) audio.stop();
+    if (wasOpen) audio.close();
+    audio.framesPerSecond(rate);
+    bool ok = !wasOpen || audio.open();
+    if (!ok) {
+      std::cerr << "⚠ WARNING: Audio device refused " << rate << " Hz, staying at " << previous
+                << " Hz: the file plays at the wrong speed and pitch" << std::endl;
+      rate = previous;
+      audio.framesPerSecond(rate);
+      if (!audio.open()) std::cerr << "✗ ERROR: Could not reopen the audio device" << std::endl;
+    }
+    setSampleRate(rate);
+    if (wasRunning) audio.start();
+    playing = wasPlaying;
+    if (ok) std::cout << "✓ Audio device now runs at " << rate << " Hz" << std::endl;
+    return ok;
+  }
+
+  // Device owner, every so often: the device delivers blocks the correction
+  // partitions don't divide (reconfigured device, small live buffers), so
+  // load the filters again partitioned for that size (a moment of silence)
+  bool matchCorrectionBlock() {
+    int frames = convolution.mismatchedBlock();
+    if (frames <= 0 || correctionFilterFile.empty()) return false;
+    std::cout << "Room correction: device delivers " << frames << "-frame blocks, partitions are "
+              << convolution.partitionFrames() << " frames: loading the filters again" << std::endl;
+    parked_file parked(*this);
+    bool ok = convolution.load(al::File::currentPath() + correctionFilterFile, expectedChannels, frames,
+                               audioSampleRate);
+    stateChanged.store(true);
+    return ok;
+  }
+
+  // GUI / control thread, every so often: warn once when the measured DSP
+  // load leaves too little headroom for the buffer size. True while unsafe.
+  bool checkLatency() {
+    float periodMs = callbackTiming.bufferPeriodMs();
+    if (periodMs <= 0.0f || callbackTiming.callbackCount() * periodMs < 2000.0f) return false;  // 2 s first
+    float load = callbackTiming.loadPercentile(0.999f);
+    bool unsafe = load > safeLoad;
+    if (unsafe && !latencyWarned) {
+      std::cerr << "⚠ WARNING: " << audioBlockSize << "-frame buffer (" << std::round(periodMs * 100.0f) / 100.0f
+                << " ms): 99.9% of callbacks use up to " << (int)(load * 100.0f) << "% of it (safe: "
+                << (int)(safeLoad * 100.0f) << "%). Underruns are likely, raise the buffer size" << std::endl;
+    }
+    latencyWarned = unsafe;
+    return unsafe;
+  }
+
+  void onSound(AudioIOData& io) {
+    TRACE_THREAD("audio");
+    callbackEdges.fetch_add(1);
+    struct leave_callback {
+      std::atomic<uint64_t>& edges;
+      ~leave_callback() { edges.fetch_add(1, std::memory_order_release); }
+    } leave{callbackEdges};
+    auto callbackStart = callbackTiming.begin(io.framesPerBuffer(), io.framesPerSecond());
+    callback_timer::scope timed{callbackTiming};
+
+    // Parked by a load / reload on another thread: silence until it is done
+    if (fileParked.load()) {
+      outputSilence(io);
+      return;
+    }
+
+    // Source block: the file's interleaved frames, or the hardware inputs
+    uint64_t numFrames = io.framesPerBuffer();
+    const float* frames = nullptr;
+    int sourceChannels = 0;
+    bool live = liveInput.load(std::memory_order_relaxed);  // One source for the whole block
+    if (live) {
+      sourceChannels = io.channelsIn();
+      if (sourceChannels == 0) {
+        outputSilence(io);
+        return;
+      }
+      // Inputs route straight from the device buffers and the channel DSP
+      // runs in audioBlockSize chunks, so a larger block still plays in full
+      // through the limiter; room correction runs it a partition at a time,
+      // or is loaded again for the new size (matchCorrectionBlock)
+      if (numFrames > (uint64_t)audioBlockSize && !blockSizeWarned) {
+        rtLog().warning("⚠ WARNING: Audio block of {} frames, player configured for {}: set audioBlockSize "
+                        "to match", numFrames, audioBlockSize);
+        blockSizeWarned = true;
+      }
+    } else if (flushTail && !buffer.empty()) {
+      numFrames = std::min<uint64_t>(numFrames, buffer.size() / numChannels);
+      std::fill(buffer.begin(), buffer.end(), 0.0f);
+      frames = buffer.data();
+      sourceChannels = numChannels;
+    } else {
+      frames = fileBlock(numFrames);
+      if (!frames) {
+        outputSilence(io);
+        return;
+      }
+      sourceChannels = numChannels;
+    }
+    callbackTiming.mark(callback_timer::STREAM);
+
+    // Route source channels to outputs straight from the source block,
+    // applying the per-output gain ramp and measuring levels in the same pass
+    // (re-measured below at the last write when correction / DSP is active)
+    int meteredChannels = std::min(io.channelsOut(), (int)blockPeak.size());
+    std::fill(blockPeak.begin(), blockPeak.end(), 0.0f);
+    std::fill(blockSumSquares.begin(), blockSumSquares.end(), 0.0f);
+    outputGains.beginBlock(gain, numFrames);
+    for (int ch = 0; ch < meteredChannels; ch++) {
+      float* out = io.outBuffer(ch);
+      int sourceChannel = (ch < (int)outputSource.size()) ? outputSource[ch] : -1;
+      if (sourceChannel < 0 || sourceChannel >= sourceChannels) {
+        std::fill(out, out + numFrames, 0.0f);
+        continue;
+      }
+      if (live) {
+        outputGains.route(ch, io.inBuffer(sourceChannel), 1, out, numFrames, blockPeak[ch], blockSumSquares[ch]);
+      } else {
+        outputGains.route(ch, frames + sourceChannel, numChannels, out, numFrames,
+                          blockPeak[ch], blockSumSquares[ch]);
+      }
+    }
+    for (int ch = meteredChannels; ch < io.channelsOut(); ch++) {
+      std::fill(io.outBuffer(ch), io.outBuffer(ch) + numFrames, 0.0f);
+    }
+    callbackTiming.mark(callback_timer::ROUTE);
+
+    // Fill remaining frames with silence if we read fewer frames
+    if (numFrames < io.framesPerBuffer()) {
+      for (int ch = 0; ch < io.channelsOut(); ch++) {
+        std::fill(io.outBuffer(ch) + numFrames, io.outBuffer(ch) + io.framesPerBuffer(), 0.0f);
+      }
+    }
+    callbackTiming.mark(callback_timer::SILENCE);
+
+    // Room correction runs on the full mapped output block
+    bool corrected = convolution.process(io, callbackStart);
+    callbackTiming.mark(callback_timer::CORRECTION);
+
+    // Channel-parallel stages on a frame-major copy of the outputs, in
+    // chunks of up to audioBlockSize frames so a larger device block still
+    // goes through the limiter
+    uint64_t blockFrames = io.framesPerBuffer();
+    bool channelStages = eq.enabled.load(std::memory_order_relaxed) ||
+                         bassManagement.enabled.load(std::memory_order_relaxed) ||
+                         limiter.enabled.load(std::memory_order_relaxed);
+    uint64_t meteredFrames = numFrames;
+    uint64_t chunkFrames = outputLanes > 0 ? frameBlock.size() / outputLanes : 0;
+    if (channelStages && chunkFrames > 0) {
+      int scattered = std::min(io.channelsOut(), outputLanes);
+      std::fill(blockPeak.begin(), blockPeak.end(), 0.0f);
+      std::fill(blockSumSquares.begin(), blockSumSquares.end(), 0.0f);
+      for (uint64_t first = 0; first < blockFrames; first += chunkFrames) {
+        int frames = (int)std::min(chunkFrames, blockFrames - first);
+        gatherOutputFrames(io, frameBlock.data(), outputLanes, frames, (int)first);
+        eq.process(frameBlock.data(), frames);
+        bassManagement.process(frameBlock.data(), frames);
+        limiter.process(frameBlock.data(), frames);
+
+        // The scatter back to the outputs is the last write: meter it there
+        for (int ch = 0; ch < scattered; ch++) {
+          float peak, sumSquares;
+          scatterMeasure(frameBlock.data(), outputLanes, ch, io.outBuffer(ch) + first, frames, peak, sumSquares);
+          if (ch < meteredChannels) {
+            blockPeak[ch] = std::max(blockPeak[ch], peak);
+            blockSumSquares[ch] += sumSquares;
+          }
+        }
+      }
+      meteredFrames = blockFrames;
+      callbackTiming.mark(callback_timer::CHANNEL_DSP);
+    } else if (corrected) {
+      // Convolution only: one measuring pass over the corrected outputs
+      for (int ch = 0; ch < meteredChannels; ch++) {
+        measureBlock(io.outBuffer(ch), blockFrames, blockPeak[ch], blockSumSquares[ch]);
+      }
+      meteredFrames = blockFrames;
+    }
+
+    // Hand the raw block levels to the GUI (ballistics happen in onDraw)
+    meters.publish(blockPeak.data(), blockSumSquares.data(), meteredFrames);
+
+    // Analysis (loudness, ...) reads this block off the audio thread
+    outputTap.write(io, blockFrames);
+    recorder.write(io, (int)blockFrames);
+    callbackTiming.mark(callback_timer::METERING);
+
+    if (!live && !flushTail) frameCounter += numFrames;
+  }
+
+  // This block's interleaved file frames (numFrames is trimmed at the end
+  // of the file), or nullptr for a silent block: nothing loaded, stopped,
+  // end of file or stream not buffered yet (not called while parked). Never allocates: a block
+  // larger than audioBlockSize plays its first audioBlockSize frames.
+  const float* fileBlock(uint64_t& numFrames) {
+    if (!soundFile.opened() || !playing || numChannels <= 0) return nullptr;
+
+    uint64_t bufferFrames = buffer.size() / numChannels;
+    if (numFrames > bufferFrames) {
+      if (!blockSizeWarned) {
+        rtLog().warning("⚠ WARNING: Audio block of {} frames, buffers sized for {}: set audioBlockSize to match",
+                     numFrames, bufferFrames);
+        blockSizeWarned = true;
+      }
+      numFrames = bufferFrames;
+    }
+
+    // Check if we're at the end
+    if (frameCounter >= soundFile.frames()) {
+      if (loop) {
+        frameCounter = 0;
+      } else {
+        playing = false;
+        stateChanged.store(true, std::memory_order_relaxed);
+        rtLog().info("⏹ End of file, playback stopped");
+        return nullptr;
+      }
+    }
+
+    // Adjust numFrames if we're near the end
+    if (frameCounter + numFrames > soundFile.frames()) {
+      numFrames = soundFile.frames() - frameCounter;
+    }
+
+    if (streamingMode) {
+      // From the prefetch ring; not buffered yet = silence, playhead holds
+      stream.loop.store(loop, std::memory_order_relaxed);
+      return stream.fetch(frameCounter, (int)numFrames, buffer.data());
+    }
+    // For non-streaming, read directly from file
+    soundFile.seek(frameCounter, SEEK_SET);
+    soundFile.read(buffer.data(), numFrames);
+    return buffer.data();
+  }
+
+  // Silent block (nothing loaded, stopped, stream not ready): still
+  // recorded, so a recording keeps time with the outputs
+  void outputSilence(AudioIOData& io) {
+    for (int ch = 0; ch < io.channelsOut(); ch++) {
+      std::fill(io.outBuffer(ch), io.outBuffer(ch) + io.framesPerBuffer(), 0.0f);
+    }
+    callbackTiming.mark(callback_timer::SILENCE);
+    recorder.write(io, (int)io.framesPerBuffer());
+  }
+};
+
+#endif // PLAYER_CORE_HPP
@@ -0,0 +1,309 @@
+/*
+  Routing verification: every file channel lands on the output the map says
+
+  Writes synthetic files in which every sample is a tag, exact in float32:
+    value = (fileChannel + 1) / 256 + (frame % 4096) / 2^22
+  so any output sample decodes back to the file channel and frame it came
+  from. Each file is played through player_core::onSound (streaming and
+  direct reads, block sizes that do and do not divide the stream slots) into
+  memory, and every output is compared against defaultChannelMap from the
+  first frame (gains jump to their targets): mapped outputs carry their
+  channel's tags, delayed by the limiter's lookahead when it is on, and all
+  others are silent.
+
+  Every DSP stage runs in a setting that leaves the signal unchanged, alone
+  and all together, so its routing is checked too:
+    limiter     below its threshold (gain 1, lookahead delay only)
+    EQ          enabled bank with flat bands (identity biquads)
+    bass        crossover at 0 Hz: the LR4 high-pass is exactly 1 and the
+                low-passed sum into the sub exactly 0
+    correction  a unit-impulse FIR on every output, no deadline
+  All of these are bit-exact except correction, which goes through the FFT:
+  it must decode to the right channel and frame (within half a frame step,
+  2^-23; the round-off is under 1e-7). The files go in a fresh mkdtemp
+  folder under the system temp directory, removed afterwards.
+
+  The two hand-written maps are also checked against each other:
+  oneIndexedChannelMap must be defaultChannelMap + 1, entry for entry.
+
+  Run: headlessplayer --verify-routing (exit 1 on any mismatch)
+*/
+
+#ifndef ROUTING_VERIFY_HPP
+#define ROUTING_VERIFY_HPP
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "bw64Writer.hpp"
+#include "channelMapping.hpp"
+#include "playerCore.hpp"
+
+struct routing_verifier {
+  double seconds = 0.25;  // Length of each test file
+  int reportLimit = 4;    // Mismatching outputs printed per configuration
+  std::string audioFolder;  // Test files, relative to the working directory (set by run())
+
+  // DSP stages switched on (in their identity settings)
+  enum Stage { LIMITER = 1, EQ = 2, BASS = 4, CORRECTION = 8, ALL_STAGES = 15 };
+
+  struct config {
+    int fileChannels;
+    int blockSize;
+    bool streaming;
+    int stages;
+  };
+
+  bool run() {
+    auto start = std::chrono::steady_clock::now();
+    std::cout << "\n=== Routing Verification ===" << std::endl;
+    bool ok = checkMaps();
+
+    // Private folder per run, so parallel runs never share or delete each other's files
+    std::string folder = makeTempFolder();
+    if (folder.empty()) {
+      std::cerr << "✗ Could not create a temporary folder for the test files" << std::endl;
+      return false;
+    }
+    // The player opens audioFolder relative to the working directory
+    std::error_code error;
+    audioFolder = std::filesystem::relative(folder, al::File::currentPath(), error).string();
+    if (error || audioFolder.empty()) {
+      std::cerr << "✗ No relative path to " << folder << std::endl;
+      std::filesystem::remove_all(folder);
+      return false;
+    }
+    audioFolder += "/";
+    folder += "/";
+    const int fileChannelCounts[] = {56, 16};  // ADM speaker renders; fewer channels than the map
+    bool written = writeUnitImpulse(folder + IMPULSE_FILE, IMPULSE_CHANNELS);
+    for (int fileChannels : fileChannelCounts) {
+      written = written && writeTaggedFile(folder + fileName(fileChannels), fileChannels);
+    }
+    if (!written) {
+      std::filesystem::remove_all(folder);
+      return false;
+    }
+
+    int passed = 0, total = 0;
+    for (int fileChannels : fileChannelCounts) {
+      for (int blockSize : {61, 512, 1000}) {
+        for (bool streaming : {true, false}) {
+          for (int stages : {0, (int)LIMITER, (int)EQ, (int)BASS, (int)CORRECTION, (int)ALL_STAGES}) {
+            total++;
+            if (verify({fileChannels, blockSize, streaming, stages})) passed++;
+          }
+        }
+      }
+    }
+    std::filesystem::remove_all(folder);
+
+    ok = ok && passed == total;
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    (ok ? std::cout : std::cerr) << (ok ? "✓ " : "✗ ") << passed << " / " << total
+                                 << " routing configurations exact (" << (int)ms << " ms)" << std::endl;
+    return ok;
+  }
+
+  // mkdtemp under the system temp directory; empty on failure
+  static std::string makeTempFolder() {
+    std::error_code error;
+    std::filesystem::path base = std::filesystem::temp_directory_path(error);
+    if (error) base = "/tmp";
+    std::string pattern = (base / "adm_verify_routing_XXXXXX").string();
+    std::vector<char> name(pattern.begin(), pattern.end());
+    name.push_back('\0');
+    if (!mkdtemp(name.data())) return "";
+    return name.data();
+  }
+
+  static float tag(int fileChannel, uint64_t frame) {
+    return (float)(fileChannel + 1) / 256.0f + (float)(frame % 4096) / 4194304.0f;
+  }
+
+  // "file ch C frame F" for a sample that is a tag, else its value
+  static std::string describe(float v) {
+    std::ostringstream s;
+    int channel = (int)std::floor(v * 256.0f) - 1;
+    if (v > 0.0f && channel >= 0) {
+      double frame = (v - (channel + 1) / 256.0) * 4194304.0;
+      s << "file ch " << channel << " frame " << (uint64_t)std::lround(frame) << " (mod 4096)";
+    } else {
+      s << v;
+    }
+    return s.str();
+  }
+
+private:
+  static constexpr const char* IMPULSE_FILE = "unit_impulse.wav";
+  static constexpr int IMPULSE_CHANNELS = 64;  // At least the player's outputs
+
+  static std::string fileName(int channels) { return "tagged_" + std::to_string(channels) + "ch.wav"; }
+
+  // File channel that should feed each output, straight from the map
+  static int expectedSource(int output, int fileChannels) {
+    for (const auto& mapping : ChannelMapping::defaultChannelMap) {
+      if (mapping.second == output) return mapping.first < fileChannels ? mapping.first : -1;
+    }
+    return -1;
+  }
+
+  bool checkMaps() {
+    bool ok = true;
+    std::vector<int> outputUses(64, 0), fileUses(64, 0);
+    for (size_t i = 0; i < ChannelMapping::defaultChannelMap.size(); i++) {
+      auto zero = ChannelMapping::defaultChannelMap[i];
+      auto one = ChannelMapping::oneIndexedChannelMap[i];
+      if (one.first != zero.first + 1 || one.second != zero.second + 1) {
+        std::cerr << "✗ Map drift at entry " << i << ": defaultChannelMap {" << zero.first << ", " << zero.second
+                  << "} vs oneIndexedChannelMap {" << one.first << ", " << one.second << "}" << std::endl;
+        ok = false;
+      }
+      if (zero.second >= 0 && zero.second < (int)outputUses.size() && ++outputUses[zero.second] == 2) {
+        std::cerr << "✗ Output " << zero.second << " is mapped more than once" << std::endl;
+        ok = false;
+      }
+      if (zero.first >= 0 && zero.first < (int)fileUses.size() && ++fileUses[zero.first] == 2) {
+        std::cerr << "✗ File channel " << zero.first << " is mapped more than once" << std::endl;
+        ok = false;
+      }
+      if (ChannelMapping::getRing(zero.second) == ChannelMapping::Ring::None) {
+        std::cerr << "✗ File channel " << zero.first << " is mapped to skipped output " << zero.second << std::endl;
+        ok = false;
+      }
+    }
+    if (ok) std::cout << "✓ defaultChannelMap and oneIndexedChannelMap agree" << std::endl;
+    return ok;
+  }
+
+  bool writeTaggedFile(const std::string& path, int channels) {
+    bw64_writer file;
+    if (!file.open(path, channels, 48000.0)) return false;
+    uint64_t frames = (uint64_t)(seconds * 48000.0);
+    std::vector<float> frame(channels);
+    for (uint64_t n = 0; n < frames; n++) {
+      for (int ch = 0; ch < channels; ch++) frame[ch] = tag(ch, n);
+      file.write(frame.data(), 1);
+    }
+    return file.close();
+  }
+
+  // A unit impulse on every channel, padded to a few partitions so the
+  // frequency-domain delay line is used too
+  bool writeUnitImpulse(const std::string& path, int channels) {
+    bw64_writer file;
+    if (!file.open(path, channels, 48000.0)) return false;
+    std::vector<float> frame(channels, 1.0f);
+    file.write(frame.data(), 1);
+    std::fill(frame.begin(), frame.end(), 0.0f);
+    for (int n = 1; n < 2048; n++) file.write(frame.data(), 1);
+    return file.close();
+  }
+
+  bool verify(const config& c) {
+    std::ostringstream name;
+    name << c.fileChannels << " ch, block " << c.blockSize << (c.streaming ? ", streaming" : ", direct read");
+    if (c.stages & LIMITER) name << ", limiter";
+    if (c.stages & EQ) name << ", EQ";
+    if (c.stages & BASS) name << ", bass";
+    if (c.stages & CORRECTION) name << ", correction";
+
+    // The player is chatty while it sets up
+    std::streambuf* console = std::cout.rdbuf();
+    std::streambuf* errors = std::cerr.rdbuf();
+    std::ostringstream quiet;
+    std::cout.rdbuf(quiet.rdbuf());
+    std::cerr.rdbuf(quiet.rdbuf());
+    std::unique_ptr<player_core> player(new player_core());
+    player->audioBlockSize = c.blockSize;
+    player->stream.logSeconds = 0.0f;
+    player->stream.logWarnings = false;
+    player->setSourceAudioFolder(audioFolder);
+    player->setInitialFile(fileName(c.fileChannels));
+    if (c.stages & CORRECTION) player->setCorrectionFilterFile(audioFolder + IMPULSE_FILE);
+    player->onInit();
+    std::cout.rdbuf(console);
+    std::cerr.rdbuf(errors);
+    if (!player->soundFile.opened()) {
+      std::cerr << "✗ " << name.str() << ": could not open the test file" << std::endl;
+      return false;
+    }
+    if ((c.stages & CORRECTION) && !player->convolution.ready()) {
+      std::cerr << "✗ " << name.str() << ": could not load the unit-impulse filter" << std::endl;
+      return false;
+    }
+    player->streamingMode = c.streaming;
+    player->eq.enabled.store((c.stages & EQ) != 0);
+    player->bassManagement.enabled.store((c.stages & BASS) != 0);
+    player->bassManagement.crossoverHz.store(0.0f);
+    player->bassManagement.jumpToTargets();
+    player->limiter.enabled.store((c.stages & LIMITER) != 0);
+    player->convolution.realTime = false;  // Every block through the filter
+    player->gain = 1.0f;
+    player->outputGains.jumpToTargets(player->gain);
+    player->loop = false;
+    player->playing = true;
+
+    // Render once through the file into memory (retry blocks not buffered yet)
+    int outputs = player->expectedChannels;
+    AudioIOData io;
+    io.channelsOut(outputs);
+    io.framesPerBuffer(c.blockSize);
+    io.framesPerSecond(player->audioSampleRate);
+    std::vector<std::vector<float>> rendered(outputs);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    uint64_t frames = (uint64_t)player->soundFile.frames();
+    while (player->frameCounter < frames && std::chrono::steady_clock::now() < deadline) {
+      uint64_t before = player->frameCounter;
+      io.frame(0);
+      player->onSound(io);
+      int advanced = (int)(player->frameCounter - before);
+      if (advanced <= 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+      for (int o = 0; o < outputs; o++) {
+        rendered[o].insert(rendered[o].end(), io.outBuffer(o), io.outBuffer(o) + advanced);
+      }
+    }
+    if (rendered[0].size() != frames) {
+      std::cerr << "✗ " << name.str() << ": rendered " << rendered[0].size() << " of " << frames << " frames"
+                << std::endl;
+      return false;
+    }
+
+    uint64_t latency = (c.stages & LIMITER) ? (uint64_t)player->limiter.latencyFrames() : 0;
+    float tolerance = (c.stages & CORRECTION) ? 1.0f / 8388608.0f : 0.0f;
+    int badOutputs = 0;
+    for (int o = 0; o < outputs; o++) {
+      int source = expectedSource(o, c.fileChannels);
+      for (uint64_t n = 0; n < frames; n++) {
+        float expected = source >= 0 && n >= latency ? tag(source, n - latency) : 0.0f;
+        if (std::fabs(rendered[o][n] - expected) <= tolerance) continue;
+        if (badOutputs++ < reportLimit) {
+          std::cerr << "✗ " << name.str() << ": output " << o << " frame " << n << " is "
+                    << describe(rendered[o][n]) << ", expected " << (source >= 0 ? describe(expected) : "silence")
+                    << std::endl;
+        }
+        break;
+      }
+    }
+    if (badOutputs > 0) {
+      std::cerr << "✗ " << name.str() << ": " << badOutputs << " outputs wrong" << std::endl;
+      return false;
+    }
+    std::cout << "✓ " << name.str() << std::endl;
+    return true;
+  }
+};
+
+#endif // ROUTING_VERIFY_HPP
@@ -0,0 +1,255 @@
+/*
+  Real-time-safe logging
+
+  The audio and streaming threads must not block on a console write, so
+  they log through here: a message is a preallocated record (format string
+  pointer, up to MAX_ARGS numeric / short text arguments copied in) pushed
+  onto a bounded lock-free queue. A background thread formats and prints
+  records every few milliseconds, in order.
+
+    rtLog().info("Loaded file [{}]: {}", index, name);
+    rtLog().warning("⚠ WARNING: Streaming buffer low: {:.0f} ms ahead", fillMs);
+
+  - Formats use {} placeholders; {:.Nf} prints a float with N decimals.
+    The format must be a string literal (only the pointer is stored); text
+    arguments are copied (up to TEXT_BYTES per record, truncated).
+  - info() goes to std::cout, warning() / error() to std::cerr. Messages
+    carry their own ✓ / ⚠ / ✗ markers like the rest of the console output.
+  - Logging never waits: when the queue is full the record is dropped and
+    counted; the formatter reports the count.
+  - Multi-producer (bounded MPMC queue with per-cell sequence numbers, one
+    consumer). After shutdown (exit) records are printed directly.
+  - The logger (and its thread) is created on first use: call rtLog() once
+    during setup, before the audio thread can be the first to log.
+*/
+
+#ifndef RT_LOG_HPP
+#define RT_LOG_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+struct rt_logger {
+  enum Level { INFO, WARNING, ERROR };
+  static constexpr int MAX_ARGS = 6;
+  static constexpr int TEXT_BYTES = 96;      // Shared by a record's text arguments
+  static constexpr size_t QUEUE_SIZE = 1024;  // Records (power of two)
+  static constexpr int FLUSH_MS = 10;
+
+  template <class... Args>
+  void info(const char* format, const Args&... args) { log(INFO, format, args...); }
+  template <class... Args>
+  void warning(const char* format, const Args&... args) { log(WARNING, format, args...); }
+  template <class... Args>
+  void error(const char* format, const Args&... args) { log(ERROR, format, args...); }
+
+  template <class... Args>
+  void log(Level level, const char* format, const Args&... args) {
+    static_assert(sizeof...(Args) <= MAX_ARGS, "rt_logger: too many arguments");
+    record r;
+    r.level = level;
+    r.format = format;
+    int unused[] = {0, (r.add(args), 0)...};
+    (void)unused;
+    if (!running.load(std::memory_order_acquire)) {
+      print(r);  // Formatter gone (exit): print in place
+      return;
+    }
+    if (!push(r)) dropped.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+  // Wait until everything logged so far is printed (not from the audio thread)
+  void flush() {
+    size_t target = enqueuePos.load(std::memory_order_acquire);
+    while (running.load(std::memory_order_acquire) && printedPos.load(std::memory_order_acquire) < target) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  // Print what is queued and stop the formatter (runs at exit)
+  void shutdown() {
+    if (!running.exchange(false)) return;
+    quit.store(true);
+    if (formatter.joinable()) formatter.join();
+  }
+
+  rt_logger() {
+    for (size_t i = 0; i < QUEUE_SIZE; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+    running.store(true);
+    formatter = std::thread([this] { formatLoop(); });
+  }
+
+private:
+  enum Kind : uint8_t { INT, UINT, FLOAT, TEXT };
+
+  struct arg {
+    Kind kind;
+    union {
+      int64_t i;
+      uint64_t u;
+      double d;
+      uint16_t textOffset;
+    };
+  };
+
+  struct record {
+    Level level = INFO;
+    const char* format = "";
+    int numArgs = 0;
+    arg args[MAX_ARGS];
+    uint16_t textUsed = 0;
+    char text[TEXT_BYTES];
+
+    template <class T>
+    void add(const T& value) {
+      arg& a = args[numArgs++];
+      if constexpr (std::is_same<T, bool>::value) {
+        addText(value ? "true" : "false", a);
+      } else if constexpr (std::is_floating_point<T>::value) {
+        a.kind = FLOAT;
+        a.d = (double)value;
+      } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+        a.kind = INT;
+        a.i = (int64_t)value;
+      } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+        a.kind = UINT;
+        a.u = (uint64_t)value;
+      } else if constexpr (std::is_same<T, std::string>::value) {
+        addText(value.c_str(), a);
+      } else {
+        addText((const char*)value, a);  // const char* / char arrays
+      }
+    }
+
+    // Copy into the text area (NUL-terminated, truncated when full)
+    void addText(const char* s, arg& a) {
+      a.kind = TEXT;
+      a.textOffset = textUsed;
+      size_t room = TEXT_BYTES - textUsed;
+      size_t n = s ? std::min(std::strlen(s), room - 1) : 0;
+      if (room > 0 && n > 0) std::memcpy(text + textUsed, s, n);
+      if (room > 0) text[textUsed + n] = '\0';
+      textUsed = (uint16_t)std::min<size_t>(TEXT_BYTES - 1, textUsed + n + 1);
+    }
+  };
+
+  struct alignas(64) cell {
+    std::atomic<size_t> sequence{0};
+    record data;
+  };
+
+  cell cells[QUEUE_SIZE];
+  alignas(64) std::atomic<size_t> enqueuePos{0};
+  alignas(64) size_t dequeuePos = 0;           // Formatter thread
+  std::atomic<size_t> printedPos{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<bool> running{false};
+  std::atomic<bool> quit{false};
+  std::thread formatter;
+
+  bool push(const record& r) {
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+      cell& c = cells[pos & (QUEUE_SIZE - 1)];
+      size_t seq = c.sequence.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+      if (diff == 0) {
+        if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          c.data = r;
+          c.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;  // Full
+      } else {
+        pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Formatter thread: print every complete record in order
+  bool drain() {
+    bool any = false;
+    for (;;) {
+      cell& c = cells[dequeuePos & (QUEUE_SIZE - 1)];
+      if (c.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+      print(c.data);
+      c.sequence.store(dequeuePos + QUEUE_SIZE, std::memory_order_release);
+      dequeuePos++;
+      printedPos.store(dequeuePos, std::memory_order_release);
+      any = true;
+    }
+    return any;
+  }
+
+  void formatLoop() {
+    uint64_t reportedDrops = 0;
+    while (!quit.load()) {
+      drain();
+      uint64_t drops = droppedCount();
+      if (drops > reportedDrops) {
+        std::cerr << "⚠ WARNING: " << drops - reportedDrops << " log messages dropped (queue full)" << std::endl;
+        reportedDrops = drops;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(FLUSH_MS));
+    }
+    drain();
+  }
+
+  static void print(const record& r) {
+    std::string line;
+    int next = 0;
+    for (const char* p = r.format; *p; p++) {
+      if (p[0] == '{' && (p[1] == '}' || p[1] == ':')) {
+        const char* close = std::strchr(p, '}');
+        if (close && next < r.numArgs) {
+          int decimals = -1;
+          if (p[1] == ':' && p[2] == '.') decimals = std::atoi(p + 3);
+          appendArg(line, r, r.args[next++], decimals);
+          p = close;
+          continue;
+        }
+      }
+      line += *p;
+    }
+    (r.level == INFO ? std::cout : std::cerr) << line << std::endl;
+  }
+
+  static void appendArg(std::string& line, const record& r, const arg& a, int decimals) {
+    char number[64];
+    switch (a.kind) {
+      case INT: std::snprintf(number, sizeof(number), "%lld", (long long)a.i); break;
+      case UINT: std::snprintf(number, sizeof(number), "%llu", (unsigned long long)a.u); break;
+      case FLOAT:
+        if (decimals >= 0) std::snprintf(number, sizeof(number), "%.*f", decimals, a.d);
+        else std::snprintf(number, sizeof(number), "%g", a.d);
+        break;
+      case TEXT: line += r.text + a.textOffset; return;
+    }
+    line += number;
+  }
+};
+
+// Process-wide logger; never destroyed, so threads may log during static
+// destruction. The formatter is stopped (queue printed) at exit.
+inline rt_logger& rtLog() {
+  static rt_logger* logger = [] {
+    rt_logger* l = new rt_logger();
+    std::atexit([] { rtLog().shutdown(); });
+    return l;
+  }();
+  return *logger;
+}
+
+#endif // RT_LOG_HPP
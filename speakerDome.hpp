@@ -0,0 +1,241 @@
+/*
+  3D speaker dome view
+
+  Every output with a speaker in the layout (speakerLayout.hpp) is drawn at
+  its azimuth / elevation / distance and colored by its meter level, for
+  the upper, middle and lower rings and the sub:
+  - all speakers (small shaded octahedra) plus a listener marker live in
+    one VAOMesh with per-vertex colors, so the whole dome is one draw call;
+    geometry is only rebuilt when a ring is shown or hidden, each frame
+    just rewrites the vertex colors
+  - levels come from the GUI-side meter ballistics, which read the
+    lock-free meter snapshot (meterBus.hpp); the audio thread never sees
+    the view
+  - drag to orbit, scroll to zoom, hover a speaker for its output and level
+
+  Split in two because ImGui and GL draw at different points of onDraw:
+  layout() reserves the view inside the current ImGui window and updates
+  colors / camera, render() draws the mesh into that rectangle after
+  g.clear() and before imguiDraw().
+*/
+
+#ifndef SPEAKER_DOME_HPP
+#define SPEAKER_DOME_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "al/graphics/al_Graphics.hpp"
+#include "al/graphics/al_VAOMesh.hpp"
+#include "al/io/al_Imgui.hpp"
+#include "al/math/al_Matrix4.hpp"
+#include "channelMapping.hpp"
+#include "speakerLayout.hpp"
+
+struct speaker_dome {
+  float speakerSize = 0.3f;   // Octahedron radius (meters, sub drawn 1.5x)
+  float floorDb = -60.0f;     // Levels at or below this show as idle
+  float fovy = 45.0f;         // Degrees
+
+  // Orbit camera around the center of the bridge
+  float yaw = 0.0f;           // Radians, 0 = looking toward the front (speaker 24)
+  float pitch = 0.45f;        // Radians above the horizon
+  float distance = 17.0f;     // Meters
+
+  void prepare(int channels) {
+    speakers.clear();
+    for (int ch = 0; ch < channels; ch++) {
+      SpeakerLayout::speaker_position p;
+      if (!SpeakerLayout::findSpeaker(ch, p)) continue;
+      dome_speaker s;
+      s.output = ch;
+      s.ring = ChannelMapping::getRing(ch);
+      float x, y, z;
+      SpeakerLayout::toCartesian(p, x, y, z);
+      // Layout X front / Y left / Z up -> GL: front = -z, left = -x, up = +y
+      s.position = al::Vec3f(-y, z, -x);
+      speakers.push_back(s);
+    }
+    builtMask = -1;
+  }
+
+  // ImGui thread, inside a window: reserve a view of the given height,
+  // handle orbit / zoom / hover and recolor from linear levels per output
+  void layout(const float* level, const bool ringVisible[ChannelMapping::NUM_RINGS], float height) {
+    int mask = 0;
+    for (int r = 0; r < ChannelMapping::NUM_RINGS; r++) mask |= ringVisible[r] ? (1 << r) : 0;
+    if (mask != builtMask) rebuild(mask);
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 64.0f), height);
+    ImGui::InvisibleButton("##dome", size);
+    ImGuiIO& io = ImGui::GetIO();
+    if (ImGui::IsItemActive() && ImGui::IsMouseDragging(0)) {
+      yaw -= io.MouseDelta.x * 0.01f;
+      pitch = std::min(std::max(pitch + io.MouseDelta.y * 0.01f, -1.4f), 1.4f);
+    }
+    if (ImGui::IsItemHovered() && io.MouseWheel != 0.0f) {
+      distance = std::min(std::max(distance * (1.0f - 0.1f * io.MouseWheel), 4.0f), 40.0f);
+    }
+    viewX = origin.x;
+    viewY = origin.y;
+    viewW = size.x;
+    viewH = size.y;
+    pending = true;
+
+    // Colors: level -> heat, times the baked face shade
+    std::vector<al::Color>& colors = mesh.colors();
+    for (const dome_speaker& s : speakers) {
+      if (s.firstVertex < 0) continue;
+      float l = level[s.output];
+      float db = l > 0.0f ? 20.0f * std::log10(l) : floorDb;
+      al::Color c = heat(db);
+      for (int v = s.firstVertex; v < s.firstVertex + VERTICES_PER_SPEAKER; v++) {
+        float k = shade[v];
+        colors[v] = al::Color(c.r * k, c.g * k, c.b * k, 1.0f);
+      }
+    }
+
+    // Hover: nearest speaker on screen within a few pixels
+    if (ImGui::IsItemHovered() && !ImGui::IsItemActive()) {
+      const dome_speaker* nearest = nullptr;
+      float best = 12.0f * 12.0f;
+      for (const dome_speaker& s : speakers) {
+        float sx, sy;
+        if (s.firstVertex < 0 || !project(s.position, sx, sy)) continue;
+        float dx = sx - io.MousePos.x, dy = sy - io.MousePos.y;
+        if (dx * dx + dy * dy < best) {
+          best = dx * dx + dy * dy;
+          nearest = &s;
+        }
+      }
+      if (nearest) {
+        float l = level[nearest->output];
+        ImGui::SetTooltip("Output %d (%s): %.1f dB", nearest->output + 1,
+                          ChannelMapping::RING_NAMES[(int)nearest->ring],
+                          l > 0.0f ? std::max(20.0f * std::log10(l), floorDb) : floorDb);
+      }
+    }
+  }
+
+  // GL: draw the dome into the rectangle reserved by this frame's layout().
+  // again: repaint the last frame's dome unchanged (no layout() this frame)
+  void render(al::Graphics& g, bool again = false) {
+    if (!again) {
+      shown = pending;
+      pending = false;
+      if (shown) mesh.update();
+    }
+    if (!shown) return;
+
+    ImGuiIO& io = ImGui::GetIO();
+    float sx = io.DisplayFramebufferScale.x, sy = io.DisplayFramebufferScale.y;
+    int fbHeight = (int)(io.DisplaySize.y * sy);
+    g.pushViewport((int)(viewX * sx), fbHeight - (int)((viewY + viewH) * sy), (int)(viewW * sx), (int)(viewH * sy));
+    g.pushProjMatrix();
+    g.projMatrix(al::Matrix4f::perspective(fovy, viewW / viewH, 0.1f, 100.0f));
+    g.pushViewMatrix();
+    g.viewMatrix(al::Matrix4f::lookAt(eye(), al::Vec3f(0, 0, 0), al::Vec3f(0, 1, 0)));
+    g.pushMatrix();
+    g.loadIdentity();
+
+    g.clearDepth();
+    g.depthTesting(true);
+    g.meshColor();
+    g.draw(mesh);
+    g.depthTesting(false);
+
+    g.popMatrix();
+    g.popViewMatrix();
+    g.popProjMatrix();
+    g.popViewport();
+  }
+
+private:
+  static constexpr int VERTICES_PER_SPEAKER = 24;  // Octahedron, 8 flat-shaded triangles
+
+  struct dome_speaker {
+    int output = 0;
+    ChannelMapping::Ring ring = ChannelMapping::Ring::None;
+    al::Vec3f position;
+    int firstVertex = -1;  // -1 = ring hidden
+  };
+
+  std::vector<dome_speaker> speakers;
+  al::VAOMesh mesh;
+  std::vector<float> shade;  // Per vertex, baked face lighting
+  int builtMask = -1;
+
+  // Rectangle reserved by layout() (ImGui screen coordinates)
+  float viewX = 0.0f, viewY = 0.0f, viewW = 1.0f, viewH = 1.0f;
+  bool pending = false;
+  bool shown = false;  // The last frame drew the dome
+
+  al::Vec3f eye() const {
+    return al::Vec3f(distance * std::cos(pitch) * std::sin(yaw), distance * std::sin(pitch),
+                     distance * std::cos(pitch) * std::cos(yaw));
+  }
+
+  // Same camera as render(), on the CPU: world -> ImGui screen position
+  bool project(const al::Vec3f& p, float& sx, float& sy) const {
+    al::Vec3f e = eye();
+    al::Vec3f forward = (al::Vec3f(0, 0, 0) - e).normalize();
+    al::Vec3f right = cross(forward, al::Vec3f(0, 1, 0)).normalize();
+    al::Vec3f up = cross(right, forward);
+    al::Vec3f d = p - e;
+    float depth = d.dot(forward);
+    if (depth <= 0.1f) return false;
+    float f = 1.0f / std::tan(fovy * (float)M_PI / 360.0f);
+    float ndcX = d.dot(right) * f / (depth * (viewW / viewH));
+    float ndcY = d.dot(up) * f / depth;
+    sx = viewX + (ndcX * 0.5f + 0.5f) * viewW;
+    sy = viewY + (0.5f - ndcY * 0.5f) * viewH;
+    return true;
+  }
+
+  // Idle gray-blue, then blue -> green -> yellow -> red up to 0 dBFS
+  al::Color heat(float db) const {
+    float t = std::min(std::max((db - floorDb) / -floorDb, 0.0f), 1.0f);
+    if (t <= 0.0f) return al::Color(0.2f, 0.22f, 0.3f);
+    if (t < 0.5f) return al::Color(0.1f, 0.3f + 1.4f * t, 1.0f - 1.6f * t);
+    float u = 2.0f * t - 1.0f;
+    return al::Color(std::min(1.0f, 2.0f * u + 0.1f), 1.0f - std::max(0.0f, 2.0f * u - 1.0f), 0.2f);
+  }
+
+  // Vertices for the visible rings plus the listener marker (always last)
+  void rebuild(int mask) {
+    builtMask = mask;
+    mesh.reset();
+    mesh.primitive(al::Mesh::TRIANGLES);
+    shade.clear();
+    for (dome_speaker& s : speakers) {
+      int r = (int)s.ring;
+      if (r >= ChannelMapping::NUM_RINGS || !(mask & (1 << r))) {
+        s.firstVertex = -1;
+        continue;
+      }
+      s.firstVertex = (int)mesh.vertices().size();
+      addOctahedron(s.position, s.ring == ChannelMapping::Ring::Sub ? 1.5f * speakerSize : speakerSize,
+                    al::Color(0.2f, 0.22f, 0.3f));
+    }
+    addOctahedron(al::Vec3f(0, 0, 0), 0.5f * speakerSize, al::Color(0.9f, 0.9f, 0.9f));
+  }
+
+  void addOctahedron(const al::Vec3f& c, float r, const al::Color& color) {
+    const al::Vec3f light = al::Vec3f(0.3f, 0.8f, 0.5f).normalize();
+    for (int face = 0; face < 8; face++) {
+      float x = (face & 1) ? -r : r, y = (face & 2) ? -r : r, z = (face & 4) ? -r : r;
+      float k = 0.55f + 0.45f * std::max(0.0f, al::Vec3f(x, y, z).normalize().dot(light));
+      al::Vec3f a = c + al::Vec3f(x, 0, 0), b = c + al::Vec3f(0, y, 0), d = c + al::Vec3f(0, 0, z);
+      mesh.vertex(a);
+      mesh.vertex(b);
+      mesh.vertex(d);
+      for (int v = 0; v < 3; v++) {
+        mesh.color(color.r * k, color.g * k, color.b * k);
+        shade.push_back(k);
+      }
+    }
+  }
+};
+
+#endif // SPEAKER_DOME_HPP
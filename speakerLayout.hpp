@@ -0,0 +1,124 @@
+/*
+  AlloSphere Speaker Positions (2025 configuration)
+
+  Azimuth / elevation / distance of every speaker, from
+  AlloSphere_Speaker_Layout.pdf. Speaker numbers are 1-indexed Allo
+  channels, as in oneIndexedChannelMap (channelMapping.hpp).
+
+  Coordinates are relative to the center of the bridge:
+  - azimuth:   radians, 0 = +X (toward speaker 24), positive toward +Y
+  - elevation: radians, 0 = ear level, positive up
+  - distance:  meters
+
+  The sub (Allo Ch 48) stands on the ground; the table gives no position
+  for it, so SUB_POSITION only places it below the front of the dome for
+  display.
+*/
+
+#ifndef SPEAKER_LAYOUT_HPP
+#define SPEAKER_LAYOUT_HPP
+
+#include <array>
+#include <cmath>
+
+namespace SpeakerLayout {
+
+struct speaker_position {
+    int speaker;      // 1-indexed Allo channel
+    float azimuth;    // radians
+    float elevation;  // radians
+    float distance;   // meters
+};
+
+constexpr int NUM_SPEAKERS = 54;
+
+constexpr std::array<speaker_position, NUM_SPEAKERS> allosphereSpeakers = {{
+    // === UPPER RING (12 speakers) - Allo Ch 1-12 ===
+    { 1,  1.355f,  0.570f, 5.929f},
+    { 2,  0.787f,  0.521f, 6.424f},
+    { 3,  0.258f,  0.497f, 6.712f},
+    { 4, -0.258f,  0.497f, 6.712f},
+    { 5, -0.787f,  0.521f, 6.424f},
+    { 6, -1.355f,  0.570f, 5.929f},
+    { 7, -1.786f,  0.570f, 5.929f},
+    { 8, -2.355f,  0.521f, 6.424f},
+    { 9, -2.883f,  0.497f, 6.712f},
+    {10,  2.883f,  0.497f, 6.712f},
+    {11,  2.355f,  0.521f, 6.424f},
+    {12,  1.786f,  0.570f, 5.929f},
+
+    // === MIDDLE RING (30 speakers) - Allo Ch 17-46 ===
+    {17,  1.355f,  0.000f, 4.992f},
+    {18,  1.146f,  0.000f, 5.219f},
+    {19,  0.944f,  0.000f, 5.425f},
+    {20,  0.748f,  0.000f, 5.604f},
+    {21,  0.557f,  0.000f, 5.749f},
+    {22,  0.370f,  0.000f, 5.856f},
+    {23,  0.184f,  0.000f, 5.922f},
+    {24,  0.000f,  0.000f, 5.944f},
+    {25, -0.184f,  0.000f, 5.922f},
+    {26, -0.370f,  0.000f, 5.856f},
+    {27, -0.557f,  0.000f, 5.749f},
+    {28, -0.748f,  0.000f, 5.604f},
+    {29, -0.944f,  0.000f, 5.425f},
+    {30, -1.146f,  0.000f, 5.219f},
+    {31, -1.355f,  0.000f, 4.992f},
+    {32, -1.786f,  0.000f, 4.992f},
+    {33, -1.996f,  0.000f, 5.219f},
+    {34, -2.198f,  0.000f, 5.425f},
+    {35, -2.393f,  0.000f, 5.604f},
+    {36, -2.584f,  0.000f, 5.749f},
+    {37, -2.772f,  0.000f, 5.856f},
+    {38, -2.957f,  0.000f, 5.922f},
+    {39, -3.142f,  0.000f, 5.944f},
+    {40,  2.957f,  0.000f, 5.922f},
+    {41,  2.772f,  0.000f, 5.856f},
+    {42,  2.584f,  0.000f, 5.749f},
+    {43,  2.393f,  0.000f, 5.604f},
+    {44,  2.198f,  0.000f, 5.425f},
+    {45,  1.996f,  0.000f, 5.219f},
+    {46,  1.786f,  0.000f, 4.992f},
+
+    // === LOWER RING (12 speakers) - Allo Ch 49-60 ===
+    {49,  1.355f, -0.483f, 5.638f},
+    {50,  0.787f, -0.440f, 6.157f},
+    {51,  0.258f, -0.418f, 6.456f},
+    {52, -0.258f, -0.418f, 6.456f},
+    {53, -0.787f, -0.440f, 6.157f},
+    {54, -1.355f, -0.483f, 5.638f},
+    {55, -1.786f, -0.483f, 5.638f},
+    {56, -2.355f, -0.440f, 6.157f},
+    {57, -2.883f, -0.418f, 6.456f},
+    {58,  2.883f, -0.418f, 6.456f},
+    {59,  2.355f, -0.440f, 6.157f},
+    {60,  1.786f, -0.483f, 5.638f}
+}};
+
+// Display position for the sub (Allo Ch 48), on the floor in front
+constexpr speaker_position SUB_POSITION = {48, 0.0f, -0.983f, 3.606f};
+
+// Cartesian position in meters (X front, Y left, Z up)
+inline void toCartesian(const speaker_position& s, float& x, float& y, float& z) {
+    x = s.distance * std::cos(s.elevation) * std::cos(s.azimuth);
+    y = s.distance * std::cos(s.elevation) * std::sin(s.azimuth);
+    z = s.distance * std::sin(s.elevation);
+}
+
+// Position of a 0-indexed Allo output; false if no speaker is connected to it
+inline bool findSpeaker(int allosphereChannel, speaker_position& out) {
+    if (allosphereChannel + 1 == SUB_POSITION.speaker) {
+        out = SUB_POSITION;
+        return true;
+    }
+    for (const auto& s : allosphereSpeakers) {
+        if (s.speaker == allosphereChannel + 1) {
+            out = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace SpeakerLayout
+
+#endif // SPEAKER_LAYOUT_HPP
@@ -0,0 +1,283 @@
+/*
+  Per-output FFT spectrum analyzer
+
+  A worker thread subscribed to the audio tap (audioTap.hpp) keeps the
+  most recent samples of every output and, 30 times per second of audio,
+  transforms the selected outputs:
+  - Hann-windowed real FFT (512 - 8192 points); one plan and one window
+    per size are built in prepare() and reused, and all buffers are sized
+    for the largest FFT up front, so changing settings never allocates
+  - power is smoothed with an exponential average per FFT bin
+  - bins are folded onto 128 log-spaced display bands (max per band)
+    and published as dB, calibrated so a full-scale sine reads 0 dB
+
+  GUI settings (size, averaging, output selection) are published to the
+  worker with commit(); results come back through a triple buffer.
+*/
+
+#ifndef SPECTRUM_ANALYZER_HPP
+#define SPECTRUM_ANALYZER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "audioTap.hpp"
+#include "fft.hpp"
+#include "tripleBuffer.hpp"
+
+constexpr int SPECTRUM_BANDS = 128;  // Log-spaced display bands, 20 Hz - Nyquist
+constexpr int NUM_SPECTRUM_SIZES = 5;
+constexpr int SPECTRUM_SIZES[NUM_SPECTRUM_SIZES] = {512, 1024, 2048, 4096, 8192};
+constexpr const char* SPECTRUM_SIZE_NAMES[NUM_SPECTRUM_SIZES] = {"512", "1024", "2048", "4096", "8192"};
+constexpr float SPECTRUM_FLOOR = -120.0f;
+
+struct spectrum_settings {
+  int sizeIndex = 2;              // Into SPECTRUM_SIZES
+  float averaging = 0.7f;         // Weight of the previous spectrum (0 = none)
+  std::vector<uint8_t> selected;  // Per output
+};
+
+struct spectrum_snapshot {
+  int fftSize = 0;
+  std::vector<float> bandsDb;     // outputs x SPECTRUM_BANDS (unselected outputs at SPECTRUM_FLOOR)
+  std::vector<float> bandHz;      // Center frequency of each band
+  std::vector<uint8_t> selected;  // Outputs analyzed for this snapshot
+  float load = 0.0f;              // Share of one core spent on the analysis
+};
+
+struct spectrum_analyzer {
+  std::atomic<bool> enabled{false};
+  static constexpr float UPDATE_RATE = 30.0f;  // Spectra per second of audio
+
+  // GUI-thread settings; call commit() after changing them
+  int sizeIndex = 2;
+  float averaging = 0.7f;
+  std::vector<uint8_t> selected;
+
+  ~spectrum_analyzer() { stop(); }
+
+  // Subscribe to the tap, build plans / windows / band tables and start the
+  // worker. Must be called before audio starts.
+  void prepare(audio_tap& source, double sampleRate) {
+    stop();
+    tap = &source;
+    consumer = tap->subscribe("Spectrum");
+    channels = tap->numChannels();
+    rate = sampleRate;
+
+    const int maxSize = SPECTRUM_SIZES[NUM_SPECTRUM_SIZES - 1];
+    for (int i = 0; i < NUM_SPECTRUM_SIZES; i++) {
+      int n = SPECTRUM_SIZES[i];
+      plans[i].init(n);
+      windows[i].resize(n);
+      for (int k = 0; k < n; k++) windows[i][k] = (float)(0.5 - 0.5 * std::cos(2.0 * M_PI * k / n));
+      buildBands(i);
+    }
+
+    history.assign((size_t)channels * maxSize, 0.0f);
+    historyPosition = 0;
+    power.assign((size_t)channels * (maxSize / 2 + 1), 0.0f);
+    frame.assign(maxSize, 0.0f);
+    re.assign(maxSize / 2 + 1, 0.0f);
+    im.assign(maxSize / 2 + 1, 0.0f);
+
+    selected.assign(channels, 1);
+    settings.init([this](spectrum_settings& s) { s.selected.assign(channels, 1); });
+    commit();
+    snapshots.init([this](spectrum_snapshot& s) {
+      s.bandsDb.assign((size_t)channels * SPECTRUM_BANDS, SPECTRUM_FLOOR);
+      s.bandHz.assign(SPECTRUM_BANDS, 0.0f);
+      s.selected.assign(channels, 0);
+    });
+
+    if (consumer < 0) {
+      std::cerr << "⚠ WARNING: Audio tap has no free consumer slot, spectrum analyzer disabled" << std::endl;
+      return;
+    }
+    quit.store(false);
+    worker = std::thread([this] { workerLoop(); });
+  }
+
+  void stop() {
+    quit.store(true);
+    if (worker.joinable()) worker.join();
+  }
+
+  // GUI thread: publish size / averaging / selection to the worker
+  void commit() {
+    spectrum_settings& s = settings.writeBuffer();
+    s.sizeIndex = std::min(std::max(sizeIndex, 0), NUM_SPECTRUM_SIZES - 1);
+    s.averaging = std::min(std::max(averaging, 0.0f), 0.99f);
+    std::copy(selected.begin(), selected.end(), s.selected.begin());
+    settings.publish();
+  }
+
+  // GUI thread: newest spectra
+  const spectrum_snapshot& latest() {
+    snapshots.update();
+    return snapshots.readBuffer();
+  }
+
+  uint64_t overflowCount() const { return consumer >= 0 && tap ? tap->overflows(consumer) : 0; }
+
+private:
+  audio_tap* tap = nullptr;
+  int consumer = -1;
+  int channels = 0;
+  double rate = 48000.0;
+
+  std::thread worker;
+  std::atomic<bool> quit{false};
+  triple_buffer<spectrum_settings> settings;
+  triple_buffer<spectrum_snapshot> snapshots;
+
+  // Per-size plans and tables, built once
+  fft_plan plans[NUM_SPECTRUM_SIZES];
+  std::vector<float> windows[NUM_SPECTRUM_SIZES];
+  std::vector<int> bandFirst[NUM_SPECTRUM_SIZES];  // First FFT bin of each band
+  std::vector<int> bandLast[NUM_SPECTRUM_SIZES];   // Last FFT bin (inclusive)
+  float bandCenter[SPECTRUM_BANDS];
+
+  // Worker-thread state, sized for the largest FFT
+  std::vector<float> history;  // outputs x maxSize, ring
+  int historyPosition = 0;
+  std::vector<float> power;    // outputs x (maxSize / 2 + 1), averaged
+  std::vector<float> frame;
+  std::vector<float> re, im;
+  int activeSize = -1;
+  double framesSinceUpdate = 0.0;
+
+  // Log-spaced bands from 20 Hz to Nyquist; every band covers at least one bin
+  void buildBands(int sizeIdx) {
+    int n = SPECTRUM_SIZES[sizeIdx];
+    int bins = n / 2 + 1;
+    double lo = 20.0, hi = rate / 2.0;
+    bandFirst[sizeIdx].resize(SPECTRUM_BANDS);
+    bandLast[sizeIdx].resize(SPECTRUM_BANDS);
+    for (int b = 0; b < SPECTRUM_BANDS; b++) {
+      double f0 = lo * std::pow(hi / lo, (double)b / SPECTRUM_BANDS);
+      double f1 = lo * std::pow(hi / lo, (double)(b + 1) / SPECTRUM_BANDS);
+      int first = std::min((int)std::lround(f0 * n / rate), bins - 1);
+      int last = std::min(std::max((int)std::lround(f1 * n / rate) - 1, first), bins - 1);
+      bandFirst[sizeIdx][b] = first;
+      bandLast[sizeIdx][b] = last;
+      bandCenter[b] = (float)std::sqrt(f0 * f1);
+    }
+  }
+
+  void workerLoop() {
+    using clock = std::chrono::steady_clock;
+    bool listening = false;
+    clock::time_point loadStart = clock::now();
+    double busySeconds = 0.0;
+    float load = 0.0f;
+
+    while (!quit.load()) {
+      bool on = enabled.load();
+      if (on != listening) {
+        tap->setActive(consumer, on);
+        listening = on;
+      }
+
+      audio_tap_block block;
+      if (!on || !tap->read(consumer, block)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        continue;
+      }
+      clock::time_point start = clock::now();
+      appendHistory(block);
+      tap->release(consumer);
+
+      framesSinceUpdate += block.frames;
+      if (framesSinceUpdate >= rate / UPDATE_RATE) {
+        framesSinceUpdate = std::fmod(framesSinceUpdate, rate / UPDATE_RATE);
+        analyze(load);
+      }
+
+      clock::time_point end = clock::now();
+      busySeconds += std::chrono::duration<double>(end - start).count();
+      double elapsed = std::chrono::duration<double>(end - loadStart).count();
+      if (elapsed >= 1.0) {
+        load = (float)(busySeconds / elapsed);
+        busySeconds = 0.0;
+        loadStart = end;
+      }
+    }
+    if (listening) tap->setActive(consumer, false);
+  }
+
+  void appendHistory(const audio_tap_block& block) {
+    const int maxSize = SPECTRUM_SIZES[NUM_SPECTRUM_SIZES - 1];
+    int frames = std::min(block.frames, maxSize);
+    int first = std::min(frames, maxSize - historyPosition);
+    for (int ch = 0; ch < channels; ch++) {
+      const float* src = block.channel(ch);
+      float* dst = &history[(size_t)ch * maxSize];
+      std::copy(src, src + first, dst + historyPosition);
+      std::copy(src + first, src + frames, dst);
+    }
+    historyPosition = (historyPosition + frames) % maxSize;
+  }
+
+  void analyze(float load) {
+    settings.update();
+    const spectrum_settings& s = settings.readBuffer();
+    const int maxSize = SPECTRUM_SIZES[NUM_SPECTRUM_SIZES - 1];
+    const int maxBins = maxSize / 2 + 1;
+    int size = SPECTRUM_SIZES[s.sizeIndex];
+    int bins = size / 2 + 1;
+    if (s.sizeIndex != activeSize) {
+      std::fill(power.begin(), power.end(), 0.0f);
+      activeSize = s.sizeIndex;
+    }
+
+    fft_plan& plan = plans[s.sizeIndex];
+    const float* window = windows[s.sizeIndex].data();
+    const int* first = bandFirst[s.sizeIndex].data();
+    const int* last = bandLast[s.sizeIndex].data();
+    float keep = s.averaging, add = 1.0f - s.averaging;
+    // Hann coherent gain 0.5: a full-scale sine peaks at size / 4
+    float norm = (4.0f / size) * (4.0f / size);
+
+    spectrum_snapshot& out = snapshots.writeBuffer();
+    out.fftSize = size;
+    std::copy(bandCenter, bandCenter + SPECTRUM_BANDS, out.bandHz.begin());
+    std::copy(s.selected.begin(), s.selected.end(), out.selected.begin());
+
+    int start = (historyPosition - size + maxSize) % maxSize;
+    for (int ch = 0; ch < channels; ch++) {
+      float* db = &out.bandsDb[(size_t)ch * SPECTRUM_BANDS];
+      if (!s.selected[ch]) {
+        std::fill(db, db + SPECTRUM_BANDS, SPECTRUM_FLOOR);
+        continue;
+      }
+
+      // Newest `size` samples, windowed
+      const float* h = &history[(size_t)ch * maxSize];
+      int tail = std::min(size, maxSize - start);
+      for (int k = 0; k < tail; k++) frame[k] = h[start + k] * window[k];
+      for (int k = tail; k < size; k++) frame[k] = h[k - tail] * window[k];
+
+      plan.forward(frame.data(), re.data(), im.data());
+
+      float* p = &power[(size_t)ch * maxBins];
+      for (int k = 0; k < bins; k++) {
+        p[k] = keep * p[k] + add * (re[k] * re[k] + im[k] * im[k]) * norm;
+      }
+      for (int b = 0; b < SPECTRUM_BANDS; b++) {
+        float peak = 0.0f;
+        for (int k = first[b]; k <= last[b]; k++) peak = p[k] > peak ? p[k] : peak;
+        db[b] = peak > 0.0f ? std::max(10.0f * std::log10(peak), SPECTRUM_FLOOR) : SPECTRUM_FLOOR;
+      }
+    }
+    out.load = load;
+    snapshots.publish();
+  }
+};
+
+#endif // SPECTRUM_ANALYZER_HPP
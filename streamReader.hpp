@@ -0,0 +1,425 @@
+/*
+  Disk streaming: background reader with a prefetch ring
+
+  A reader thread keeps the next prefetchSeconds of the file in a ring of
+  fixed-size slots (SLOT_FRAMES interleaved frames each, tagged with their
+  file position); the audio thread only takes frames out of the ring, so it
+  never touches the disk.
+  - fetch() returns the block at the playhead: straight from the slot when
+    the block lies inside one, otherwise copied into the caller's scratch
+  - a playhead that jumps (rewind, seek, file end with loop off) asks the
+    reader to reposition; slots from before the jump are dropped unread.
+    Looping is seamless: at the end of the file the reader continues at 0
+  - after a jump playback resumes once lowWaterMs is buffered (or the
+    ring is full / the file ends), so a disk slower than the file's rate
+    shows up as underruns rather than endless stutter during the refill
+  - if the block is not buffered yet fetch() returns nullptr and the
+    caller plays silence without advancing (an underrun)
+
+  Telemetry, lock-free (each figure has a single writer thread):
+  - fill: ms buffered ahead of the playhead, and the minimum while playing
+  - near-underruns: fill fell below lowWaterMs while playing
+  - read latency per slot read (seek + read), log histogram -> percentiles
+  - read throughput (MB/s while reading) vs the rate the file needs
+  Source is the file type the reader thread reads through: gam::SoundFile
+  in the player, a throttled stand-in in bench/benchStreaming.cpp
+  (latency, stalls and throughput caps; see streamingWAV.md).
+
+  Near-underruns and underruns are logged where they happen (rtLog.hpp,
+  the audio thread only queues the record), plus a summary every
+  logSeconds while streaming. Reads, seeks and underruns are
+  also trace events (traceRecorder.hpp).
+*/
+
+#ifndef STREAM_READER_HPP
+#define STREAM_READER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Gamma/SoundFile.h"
+#include "rtLog.hpp"
+#include "traceRecorder.hpp"
+
+template <class Source = gam::SoundFile>
+struct basic_stream_reader {
+  static constexpr int SLOT_FRAMES = 4096;
+  static constexpr int LATENCY_BINS = 48;         // 0.01 ms - 10 s, 8 bins per decade
+  static constexpr int LATENCY_BINS_PER_DECADE = 8;
+  static constexpr float LATENCY_MIN_MS = 0.01f;
+
+  float prefetchSeconds = 2.0f;  // Ring size, applied at open()
+  float lowWaterMs = 250.0f;     // Fill below this while playing = near-underrun
+  float logSeconds = 60.0f;      // Summary log interval while streaming (0 = off)
+  bool logWarnings = true;       // Log near-underruns / underruns as they happen
+  std::atomic<bool> loop{true};  // Continue at frame 0 after the end of the file
+
+  ~basic_stream_reader() { close(); }
+
+  // Open the file with the reader's own handle, size the ring, start reading at 0
+  bool open(const std::string& path) {
+    close();
+    if (!file.openRead(path)) {
+      std::cerr << "✗ ERROR: Streaming reader could not open: " << path << std::endl;
+      return false;
+    }
+    fileChannels = file.channels();
+    fileFrames = (uint64_t)file.frames();
+    rate = file.frameRate() > 0 ? file.frameRate() : 48000.0;
+    std::error_code error;
+    uintmax_t bytes = std::filesystem::file_size(path, error);
+    bytesPerFrame = (!error && fileFrames > 0) ? (double)bytes / fileFrames : fileChannels * 4.0;
+
+    slots = std::max<uint64_t>(2, (uint64_t)std::ceil(prefetchSeconds * rate / SLOT_FRAMES));
+    ringData.assign((size_t)slots * SLOT_FRAMES * fileChannels, 0.0f);
+    slotPosition.assign(slots, 0);
+    slotFrames.assign(slots, 0);
+    slotGeneration.assign(slots, 0);
+    writeIndex.store(0);
+    readIndex.store(0);
+    generation.store(0);
+    seekPosition.store(0);
+    readerGeneration = 0;
+    expected = 0;
+    offset = 0;
+    toRelease = 0;
+    refilling = true;
+    low = false;
+    starving = false;
+    clearAudioStats();
+    clearReaderStats();
+
+    quit.store(false);
+    worker = std::thread([this] { readerLoop(); });
+    ready.store(true, std::memory_order_release);
+    std::cout << "✓ Streaming: " << prefetchSeconds << " s prefetch (" << slots << " x " << SLOT_FRAMES
+              << " frames, " << (ringData.size() * sizeof(float)) / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+  }
+
+  void close() {
+    ready.store(false, std::memory_order_release);
+    quit.store(true);
+    if (worker.joinable()) worker.join();
+    file.close();
+  }
+
+  int channels() const { return fileChannels; }
+  uint64_t frames() const { return fileFrames; }
+
+  // The reader's own file handle (configure a stand-in source before open())
+  Source& source() { return file; }
+
+  // ---- Audio thread ----
+
+  // Interleaved frames [position, position + frames), valid until the next
+  // fetch(); nullptr if they are not buffered yet. scratch: frames x channels.
+  const float* fetch(uint64_t position, int frames, float* scratch) {
+    if (!ready.load(std::memory_order_acquire)) return nullptr;
+    if (resetAudio.load(std::memory_order_acquire)) {
+      clearAudioStats();
+      resetAudio.store(false, std::memory_order_release);
+    }
+    // Slots handed out by the previous fetch() are free now
+    if (toRelease > 0) {
+      readIndex.fetch_add(toRelease, std::memory_order_release);
+      toRelease = 0;
+    }
+    uint64_t r = readIndex.load(std::memory_order_relaxed);
+    uint64_t w = writeIndex.load(std::memory_order_acquire);
+    uint32_t gen = generation.load(std::memory_order_relaxed);
+
+    // Drop slots read before the last jump
+    while (r < w && slotGeneration[r % slots] != gen) {
+      readIndex.fetch_add(1, std::memory_order_release);
+      r++;
+      offset = 0;
+    }
+
+    if (position != expected) {
+      // The reader may already be there (loop wrap to 0); otherwise jump
+      if (r < w && slotPosition[r % slots] == position) {
+        offset = 0;
+      } else {
+        seekPosition.store(position, std::memory_order_relaxed);
+        generation.store(gen + 1, std::memory_order_release);
+        readIndex.store(w, std::memory_order_release);  // Everything buffered is stale
+        offset = 0;
+        refilling = true;
+        expected = position;
+        fill.store(0.0f, std::memory_order_relaxed);
+        TRACE_INSTANT("stream seek");
+        return nullptr;
+      }
+      expected = position;
+    }
+
+    // Contiguous frames buffered ahead of the playhead
+    uint64_t ahead = 0, next = position;
+    for (uint64_t k = r; k < w; k++) {
+      size_t s = k % slots;
+      bool wrapped = next >= fileFrames && slotPosition[s] == 0;  // Loop: reader went back to 0
+      if (slotGeneration[s] != gen || (k > r && slotPosition[s] != next && !wrapped)) break;
+      ahead += slotFrames[s] - (k == r ? offset : 0);
+      next = slotPosition[s] + slotFrames[s];
+    }
+    float fillNow = (float)(ahead * 1000.0 / rate);
+    fill.store(fillNow, std::memory_order_relaxed);
+    bool atEnd = !loop.load(std::memory_order_relaxed) && next >= fileFrames;
+    if (refilling && (fillNow >= lowWaterMs || atEnd || r + slots <= w)) refilling = false;
+    if (refilling) return nullptr;  // Pre-roll: start once lowWaterMs is buffered
+
+    if (ahead < (uint64_t)frames) {
+      if (!atEnd) {
+        bump(underruns);
+        TRACE_INSTANT("stream underrun");
+        if (!starving && logWarnings) {
+          rtLog().error("✗ Streaming underrun at {:.2f} s: playhead caught up with the disk ({} total)",
+                        position / rate, underrunCount());
+        }
+        starving = true;
+      }
+      return nullptr;
+    }
+    if (!atEnd) {
+      if (fillNow < minFill.load(std::memory_order_relaxed)) minFill.store(fillNow, std::memory_order_relaxed);
+      bool isLow = fillNow < lowWaterMs;
+      if (isLow && !low) {
+        bump(nearUnderruns);
+        TRACE_INSTANT("stream buffer low");
+        if (logWarnings) {
+          rtLog().warning("⚠ WARNING: Streaming buffer low: {:.0f} ms ahead ({} near-underruns)", fillNow,
+                          nearUnderrunCount());
+        }
+      }
+      low = isLow;
+    }
+
+    starving = false;
+
+    // Inside one slot: hand out the slot itself
+    size_t s = r % slots;
+    const float* result;
+    if (slotFrames[s] - offset >= frames) {
+      result = slotData(s) + (size_t)offset * fileChannels;
+      offset += frames;
+    } else {
+      int copied = 0;
+      while (copied < frames) {
+        s = (r + toRelease) % slots;
+        int n = std::min(frames - copied, slotFrames[s] - offset);
+        std::memcpy(scratch + (size_t)copied * fileChannels, slotData(s) + (size_t)offset * fileChannels,
+                    (size_t)n * fileChannels * sizeof(float));
+        copied += n;
+        offset += n;
+        if (offset == slotFrames[s] && copied < frames) {
+          toRelease++;
+          offset = 0;
+        }
+      }
+      result = scratch;
+    }
+    if (offset == slotFrames[s]) {
+      toRelease++;
+      offset = 0;
+    }
+    expected = position + frames;
+    return result;
+  }
+
+  // ---- Stats (any thread) ----
+
+  float fillMs() const { return fill.load(std::memory_order_relaxed); }
+  float minFillMs() const {
+    float m = minFill.load(std::memory_order_relaxed);
+    return m == NO_FILL ? 0.0f : m;
+  }
+  float prefetchMs() const { return (float)(slots * SLOT_FRAMES * 1000.0 / rate); }
+  uint64_t nearUnderrunCount() const { return nearUnderruns.load(std::memory_order_relaxed); }
+  uint64_t underrunCount() const { return underruns.load(std::memory_order_relaxed); }
+  uint64_t readCount() const { return reads.load(std::memory_order_relaxed); }
+  float maxReadMs() const { return maxRead.load(std::memory_order_relaxed); }
+
+  // Upper edge of the histogram bin holding the p-th percentile (0-1) read
+  float readPercentileMs(float p) const {
+    uint64_t total = readCount();
+    if (total == 0) return 0.0f;
+    uint64_t target = (uint64_t)std::ceil(p * total), seen = 0;
+    for (int b = 0; b < LATENCY_BINS; b++) {
+      seen += latency[b].load(std::memory_order_relaxed);
+      if (seen >= target) return binUpperMs(b);
+    }
+    return binUpperMs(LATENCY_BINS - 1);
+  }
+
+  // Disk speed while a read is in progress, and what real-time playback needs
+  float readMBps() const { return readSpeed.load(std::memory_order_relaxed); }
+  float requiredMBps() const { return (float)(bytesPerFrame * rate / 1e6); }
+
+  void requestReset() {
+    resetAudio.store(true, std::memory_order_release);
+    resetReader.store(true, std::memory_order_release);
+  }
+
+private:
+  static constexpr float NO_FILL = 1e30f;
+
+  Source file;  // Reader thread only (after open)
+  int fileChannels = 0;
+  uint64_t fileFrames = 0;
+  double rate = 48000.0;
+  double bytesPerFrame = 0.0;
+
+  uint64_t slots = 2;
+  std::vector<float> ringData;          // slots x SLOT_FRAMES x channels
+  std::vector<uint64_t> slotPosition;   // File frame of each slot's first frame
+  std::vector<int> slotFrames;
+  std::vector<uint32_t> slotGeneration;
+  std::atomic<uint64_t> writeIndex{0};  // Reader
+  std::atomic<uint64_t> readIndex{0};   // Audio thread
+  std::atomic<uint32_t> generation{0};  // Bumped by the audio thread on every jump
+  std::atomic<uint64_t> seekPosition{0};
+
+  std::thread worker;
+  std::atomic<bool> quit{false};
+  std::atomic<bool> ready{false};       // Ring sized and reader running
+  uint32_t readerGeneration = 0;        // Reader thread state
+
+  // Audio-thread state
+  uint64_t expected = 0;                // Playhead the ring is positioned for
+  int offset = 0;                       // Frames used from the front slot
+  uint64_t toRelease = 0;
+  bool refilling = true;
+  bool low = false;
+  bool starving = false;                // Underrun already logged
+
+  // Audio-thread stats
+  std::atomic<float> fill{0.0f};
+  std::atomic<float> minFill{NO_FILL};
+  std::atomic<uint64_t> nearUnderruns{0};
+  std::atomic<uint64_t> underruns{0};
+  std::atomic<bool> resetAudio{false};
+
+  // Reader-thread stats
+  std::atomic<uint64_t> latency[LATENCY_BINS] = {};
+  std::atomic<uint64_t> reads{0};
+  std::atomic<float> maxRead{0.0f};
+  std::atomic<float> readSpeed{0.0f};
+  std::atomic<bool> resetReader{false};
+
+  float* slotData(size_t s) { return &ringData[s * SLOT_FRAMES * fileChannels]; }
+
+  static void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  static float binUpperMs(int b) {
+    return LATENCY_MIN_MS * std::pow(10.0f, (float)(b + 1) / LATENCY_BINS_PER_DECADE);
+  }
+
+  void clearAudioStats() {
+    minFill.store(NO_FILL, std::memory_order_relaxed);
+    nearUnderruns.store(0, std::memory_order_relaxed);
+    underruns.store(0, std::memory_order_relaxed);
+  }
+
+  void clearReaderStats() {
+    for (auto& b : latency) b.store(0, std::memory_order_relaxed);
+    reads.store(0, std::memory_order_relaxed);
+    maxRead.store(0.0f, std::memory_order_relaxed);
+  }
+
+  void readerLoop() {
+    using clock = std::chrono::steady_clock;
+    uint64_t position = 0;
+    bool reposition = true;
+    double busySeconds = 0.0, bytesRead = 0.0;
+    clock::time_point lastLog = clock::now();
+    uint64_t lastRead = readIndex.load();
+    TRACE_THREAD("stream reader");
+
+    while (!quit.load()) {
+      if (resetReader.load(std::memory_order_acquire)) {
+        clearReaderStats();
+        resetReader.store(false, std::memory_order_release);
+      }
+      uint32_t gen = generation.load(std::memory_order_acquire);
+      if (gen != readerGeneration) {
+        readerGeneration = gen;
+        position = seekPosition.load(std::memory_order_relaxed);
+        reposition = true;
+      }
+
+      uint64_t w = writeIndex.load(std::memory_order_relaxed);
+      bool full = w - readIndex.load(std::memory_order_acquire) >= slots;
+      bool done = position >= fileFrames && !loop.load(std::memory_order_relaxed);
+      if (full || done) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      } else {
+        if (position >= fileFrames) {
+          position = 0;  // Loop: keep reading from the top
+          reposition = true;
+        }
+        size_t s = w % slots;
+        int n = (int)std::min<uint64_t>(SLOT_FRAMES, fileFrames - position);
+        clock::time_point start = clock::now();
+        if (reposition) file.seek((int)position, SEEK_SET);
+        int got = file.read(slotData(s), n);
+        clock::time_point finish = clock::now();
+        TRACE_COMPLETE("disk read", start, finish);
+        double seconds = std::chrono::duration<double>(finish - start).count();
+        reposition = false;
+        if (got < n) std::fill(slotData(s) + (size_t)std::max(got, 0) * fileChannels,
+                               slotData(s) + (size_t)n * fileChannels, 0.0f);
+        slotPosition[s] = position;
+        slotFrames[s] = n;
+        slotGeneration[s] = readerGeneration;
+        writeIndex.store(w + 1, std::memory_order_release);
+        position += n;
+
+        recordRead(seconds);
+        busySeconds += seconds;
+        bytesRead += n * bytesPerFrame;
+        if (busySeconds >= 0.05) {
+          readSpeed.store((float)(bytesRead / busySeconds / 1e6), std::memory_order_relaxed);
+          busySeconds = 0.0;
+          bytesRead = 0.0;
+        }
+      }
+
+      // Periodic summary while the playhead moves
+      clock::time_point now = clock::now();
+      if (logSeconds > 0.0f && std::chrono::duration<double>(now - lastLog).count() >= logSeconds) {
+        uint64_t r = readIndex.load(std::memory_order_relaxed);
+        if (r != lastRead) {
+          rtLog().info("Streaming: {:.0f} ms buffered (min {:.0f}), read p50 {} / p99 {} ms, {:.0f} MB/s (needs {:.1f})",
+                       fillMs(), minFillMs(), readPercentileMs(0.5f), readPercentileMs(0.99f), readMBps(),
+                       requiredMBps());
+          rtLog().info("Streaming: {} near-underruns, {} underruns", nearUnderrunCount(), underrunCount());
+        }
+        lastRead = r;
+        lastLog = now;
+      }
+    }
+  }
+
+  void recordRead(double seconds) {
+    float ms = (float)(seconds * 1000.0);
+    int bin = ms > LATENCY_MIN_MS ? (int)(std::log10(ms / LATENCY_MIN_MS) * LATENCY_BINS_PER_DECADE) : 0;
+    bump(latency[std::min(bin, LATENCY_BINS - 1)]);
+    bump(reads);
+    if (ms > maxRead.load(std::memory_order_relaxed)) maxRead.store(ms, std::memory_order_relaxed);
+  }
+};
+
+using stream_reader = basic_stream_reader<>;
+
+#endif // STREAM_READER_HPP
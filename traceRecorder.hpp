@@ -0,0 +1,250 @@
+/*
+  Trace recording (Chrome trace-event JSON, opens in ui.perfetto.dev)
+
+  Scoped events from the audio callback, the streaming reader, file loads,
+  the convolution workers and the GUI, on one timeline, so a dropout can be
+  lined up with the disk read or GUI frame next to it.
+
+  - Every thread writes into its own fixed ring of events (a flight
+    recorder: the oldest events are overwritten), claimed on its first
+    event. No locks, no allocation; an event is a few relaxed stores.
+  - start() allocates the rings (once) and arms recording; writeJson()
+    flushes everything recorded since start() from any thread, reading the
+    rings while they are being written (per-event sequence numbers drop
+    events overwritten mid-copy).
+  - Disarmed, a scope costs one relaxed load. Built without ADM_TRACE the
+    macros are empty and nothing is recorded (CMake option ADM_TRACE).
+
+  Event names must be string literals (only the pointer is stored).
+*/
+
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct trace_recorder {
+  static constexpr int MAX_THREADS = 24;
+  static constexpr uint64_t EVENTS_PER_THREAD = 1 << 15;  // ~30 s of audio callbacks
+#ifdef ADM_TRACE
+  static constexpr bool compiledIn = true;
+#else
+  static constexpr bool compiledIn = false;
+#endif
+  using clock = std::chrono::steady_clock;
+
+  // ---- Recording threads ----
+
+  bool active() const { return armed.load(std::memory_order_acquire); }
+
+  // Complete event ("ph":"X") from timestamps the caller already has
+  void complete(const char* name, clock::time_point start, clock::time_point end) {
+    if (!active()) return;
+    record(name, toNs(start), (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+  }
+
+  // Instant event ("ph":"i"): underruns, late callbacks
+  void instant(const char* name) {
+    if (!active()) return;
+    record(name, toNs(clock::now()), INSTANT);
+  }
+
+  // Name shown for the calling thread's track (kept if the thread records later)
+  void nameThread(const char* name) {
+    threadName() = name;
+    if (thread_buffer* b = claimedBuffer()) b->name.store(name, std::memory_order_relaxed);
+  }
+
+  struct scope {
+    trace_recorder& recorder;
+    const char* name;
+    clock::time_point start;
+    scope(trace_recorder& r, const char* n) : recorder(r), name(n), start(r.active() ? clock::now() : clock::time_point()) {}
+    ~scope() {
+      if (start != clock::time_point()) recorder.complete(name, start, clock::now());
+    }
+  };
+
+  // ---- Control (GUI / control thread) ----
+
+  void start() {
+    if (!compiledIn) {
+      std::cerr << "⚠ WARNING: Tracing not compiled in (configure with -DADM_TRACE=ON)" << std::endl;
+      return;
+    }
+    if (!storage) {
+      storage.reset(new event[(size_t)MAX_THREADS * EVENTS_PER_THREAD]);
+      for (int t = 0; t < MAX_THREADS; t++) buffers[t].events = storage.get() + (size_t)t * EVENTS_PER_THREAD;
+    }
+    sessionStartNs = toNs(clock::now());
+    armed.store(true, std::memory_order_release);
+    std::cout << "✓ Trace recording started" << std::endl;
+  }
+
+  void stop() {
+    if (!armed.load()) return;
+    armed.store(false, std::memory_order_release);
+    std::cout << "Trace recording stopped" << std::endl;
+  }
+
+  // Everything recorded since start(), as Chrome trace-event JSON
+  bool writeJson(const std::string& path) const {
+    if (!storage) {
+      std::cerr << "✗ ERROR: No trace recorded (start tracing first)" << std::endl;
+      return false;
+    }
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+      std::cerr << "✗ ERROR: Could not write trace: " << path << std::endl;
+      return false;
+    }
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"adm-allo-player\"}}");
+    size_t written = 0;
+    int threads = std::min(nextSlot.load(std::memory_order_acquire), MAX_THREADS);
+    for (int t = 0; t < threads; t++) {
+      const thread_buffer& b = buffers[t];
+      const char* name = b.name.load(std::memory_order_relaxed);
+      std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                   t + 1, name ? name : "thread");
+      std::fprintf(file, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+                   t + 1, t);
+
+      uint64_t end = b.count.load(std::memory_order_acquire);
+      uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+      for (uint64_t i = begin; i < end; i++) {
+        snapshot e;
+        if (!b.events[i % EVENTS_PER_THREAD].read(i + 1, e) || e.startNs < sessionStartNs) continue;
+        double ts = (e.startNs - sessionStartNs) * 1e-3;
+        if (e.durationNs == INSTANT) {
+          std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                       e.name, t + 1, ts);
+        } else {
+          std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                       e.name, t + 1, ts, e.durationNs * 1e-3);
+        }
+        written++;
+      }
+    }
+    std::fprintf(file, "\n]}\n");
+    bool ok = std::fclose(file) == 0;
+    if (ok) std::cout << "✓ Trace written to " << path << " (" << written << " events, " << threads << " threads)" << std::endl;
+    return ok;
+  }
+
+  int threadCount() const { return std::min(nextSlot.load(std::memory_order_relaxed), MAX_THREADS); }
+
+private:
+  static constexpr uint64_t INSTANT = ~0ull;
+
+  struct snapshot {
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+  };
+
+  // Seqlock-style slot: seq = index + 1 once complete, 0 while being written
+  struct event {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> startNs{0};
+    std::atomic<uint64_t> durationNs{0};
+
+    void write(uint64_t sequence, const char* n, uint64_t start, uint64_t duration) {
+      seq.store(0, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      name.store(n, std::memory_order_relaxed);
+      startNs.store(start, std::memory_order_relaxed);
+      durationNs.store(duration, std::memory_order_relaxed);
+      seq.store(sequence, std::memory_order_release);
+    }
+
+    bool read(uint64_t sequence, snapshot& out) const {
+      if (seq.load(std::memory_order_acquire) != sequence) return false;
+      out.name = name.load(std::memory_order_relaxed);
+      out.startNs = startNs.load(std::memory_order_relaxed);
+      out.durationNs = durationNs.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return seq.load(std::memory_order_relaxed) == sequence && out.name;
+    }
+  };
+
+  struct thread_buffer {
+    event* events = nullptr;
+    std::atomic<uint64_t> count{0};  // Events ever written (single writer)
+    std::atomic<const char*> name{nullptr};
+  };
+
+  const clock::time_point epoch = clock::now();
+  std::unique_ptr<event[]> storage;
+  thread_buffer buffers[MAX_THREADS];
+  std::atomic<int> nextSlot{0};
+  std::atomic<bool> armed{false};
+  uint64_t sessionStartNs = 0;
+
+  uint64_t toNs(clock::time_point t) const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch).count();
+  }
+
+  static const char*& threadName() {
+    static thread_local const char* name = nullptr;
+    return name;
+  }
+
+  static thread_buffer*& threadSlot() {
+    static thread_local thread_buffer* slot = nullptr;
+    return slot;
+  }
+
+  thread_buffer* claimedBuffer() const { return threadSlot(); }
+
+  // The calling thread's ring, claimed on its first event (nullptr = all taken)
+  thread_buffer* threadBuffer() {
+    thread_buffer*& slot = threadSlot();
+    if (!slot) {
+      int index = nextSlot.fetch_add(1, std::memory_order_acq_rel);
+      if (index >= MAX_THREADS) return nullptr;  // Keep counting: later threads stay unrecorded
+      slot = &buffers[index];
+      slot->name.store(threadName(), std::memory_order_relaxed);
+    }
+    return slot;
+  }
+
+  void record(const char* name, uint64_t startNs, uint64_t durationNs) {
+    thread_buffer* b = threadBuffer();
+    if (!b) return;
+    uint64_t i = b->count.load(std::memory_order_relaxed);
+    b->events[i % EVENTS_PER_THREAD].write(i + 1, name, startNs, durationNs);
+    b->count.store(i + 1, std::memory_order_release);
+  }
+};
+
+inline trace_recorder& tracer() {
+  static trace_recorder recorder;
+  return recorder;
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef ADM_TRACE
+#define TRACE_SCOPE(name) trace_recorder::scope TRACE_CONCAT(traceScope, __LINE__)(tracer(), name)
+#define TRACE_COMPLETE(name, start, end) tracer().complete(name, start, end)
+#define TRACE_INSTANT(name) tracer().instant(name)
+#define TRACE_THREAD(name) tracer().nameThread(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_COMPLETE(name, start, end) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+#endif
+
+#endif // TRACE_RECORDER_HPP
@@ -0,0 +1,49 @@
+/*
+  Lock-free triple buffer (single producer, single consumer)
+
+  The writer always has a private buffer to fill and the reader always
+  has a private buffer to read; publish() and update() just swap indices
+  through one atomic. Neither side ever blocks or waits on the other, and
+  the reader always sees the most recently published complete buffer.
+  Buffers are sized up front (init), so swapping never allocates.
+*/
+
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+
+template <class T>
+struct triple_buffer {
+  // Apply the same setup to all three buffers (call before use)
+  template <class Fn>
+  void init(Fn&& setup) {
+    for (auto& b : buffers) setup(b);
+  }
+
+  // Writer side: fill writeBuffer(), then publish() it
+  T& writeBuffer() { return buffers[backIndex]; }
+  void publish() {
+    backIndex = middle.exchange(backIndex | DIRTY, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  // Reader side: update() picks up the newest published buffer if there is one
+  bool update() {
+    if (!(middle.load(std::memory_order_acquire) & DIRTY)) return false;
+    frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+  const T& readBuffer() const { return buffers[frontIndex]; }
+  T& readBuffer() { return buffers[frontIndex]; }
+
+private:
+  static constexpr int DIRTY = 4;
+  static constexpr int INDEX_MASK = 3;
+
+  T buffers[3];
+  std::atomic<int> middle{1};
+  int backIndex = 0;   // Owned by the writer
+  int frontIndex = 2;  // Owned by the reader
+};
+
+#endif // TRIPLE_BUFFER_HPP
@@ -0,0 +1,70 @@
+/*
+  Counting semaphore for waking worker threads from the audio thread
+
+  post() never blocks or takes a lock, so the audio thread can call it;
+  wait() sleeps in the kernel until a post arrives, with no timeout and no
+  polling. Each platform's own semaphore:
+    Linux   POSIX sem_t (futex based: a post nobody sleeps on stays in
+            user space)
+    macOS   dispatch semaphore (unnamed POSIX semaphores are not
+            implemented there)
+    Windows kernel semaphore
+*/
+
+#ifndef WAKE_SEMAPHORE_HPP
+#define WAKE_SEMAPHORE_HPP
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <climits>
+#else
+#include <cerrno>
+#include <semaphore.h>
+#endif
+
+struct wake_semaphore {
+#if defined(__APPLE__)
+  wake_semaphore() : sem(dispatch_semaphore_create(0)) {}
+  ~wake_semaphore() { dispatch_release(sem); }
+  void post(int count = 1) {
+    for (int i = 0; i < count; i++) dispatch_semaphore_signal(sem);
+  }
+  void wait() { dispatch_semaphore_wait(sem, DISPATCH_TIME_FOREVER); }
+#elif defined(_WIN32)
+  wake_semaphore() : sem(CreateSemaphoreA(nullptr, 0, LONG_MAX, nullptr)) {}
+  ~wake_semaphore() { CloseHandle(sem); }
+  void post(int count = 1) {
+    if (count > 0) ReleaseSemaphore(sem, count, nullptr);
+  }
+  void wait() { WaitForSingleObject(sem, INFINITE); }
+#else
+  wake_semaphore() { sem_init(&sem, 0, 0); }
+  ~wake_semaphore() { sem_destroy(&sem); }
+  void post(int count = 1) {
+    for (int i = 0; i < count; i++) sem_post(&sem);
+  }
+  void wait() {
+    while (sem_wait(&sem) != 0 && errno == EINTR) {
+    }
+  }
+#endif
+
+  wake_semaphore(const wake_semaphore&) = delete;
+  wake_semaphore& operator=(const wake_semaphore&) = delete;
+
+private:
+#if defined(__APPLE__)
+  dispatch_semaphore_t sem;
+#elif defined(_WIN32)
+  HANDLE sem;
+#else
+  sem_t sem;
+#endif
+};
+
+#endif // WAKE_SEMAPHORE_HPP